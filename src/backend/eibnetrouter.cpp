@@ -42,7 +42,7 @@ EIBNetIPRouter::start()
   baddr.sin_family = AF_INET;
   baddr.sin_port = htons (port);
   baddr.sin_addr.s_addr = htonl (INADDR_ANY);
-  sock = new EIBNetIPSocket (baddr, 1, t);
+  sock = new EIBNetIPSocket (evloop, baddr, 1, t);
   if (!sock->init ())
     goto err_out;
   sock->on_recv.set<EIBNetIPRouter,&EIBNetIPRouter::read_cb>(this);
@@ -148,11 +148,12 @@ EIBNetIPRouter::read_cb(EIBNetIPPacket *p)
   delete p;
   if (c)
     {
+      L_Data_Stamp (*c);
       if (!monitor)
         recv_L_Data (std::move(c));
       else
         {
-          LBusmonPtr p1 = LBusmonPtr(new L_Busmon_PDU ());
+          LBusmonPtr p1 = L_Busmon_New ();
           p1->lpdu = L_Data_to_CM_TP1 (c);
           recv_L_Busmonitor (std::move(p1));
         }
@@ -87,8 +87,11 @@ EIBNetIPTunnel::start()
 {
   TRACEPRINTF (t, 2, "Open");
 
+  timeout.set (evloop);
   timeout.set <EIBNetIPTunnel,&EIBNetIPTunnel::timeout_cb> (this);
+  conntimeout.set (evloop);
   conntimeout.set <EIBNetIPTunnel,&EIBNetIPTunnel::conntimeout_cb> (this);
+  trigger.set (evloop);
   trigger.set <EIBNetIPTunnel,&EIBNetIPTunnel::trigger_cb> (this);
 
   trigger.start();
@@ -101,7 +104,7 @@ EIBNetIPTunnel::start()
     goto ex;
   raddr.sin_port = htons (sport);
   NAT = false;
-  sock = new EIBNetIPSocket (raddr, (sport != 0), t);
+  sock = new EIBNetIPSocket (evloop, raddr, (sport != 0), t);
   if (!sock->init ())
     goto ex;
   raddr.sin_port = sock->port();
@@ -302,11 +305,12 @@ EIBNetIPTunnel::read_cb (EIBNetIPPacket *p1)
       c = CEMI_to_L_Data (treq.CEMI, t);
       if (c)
         {
+          L_Data_Stamp (*c);
           if (!monitor)
             recv_L_Data (std::move(c));
           else
             {
-              LBusmonPtr p1 = LBusmonPtr(new L_Busmon_PDU ());
+              LBusmonPtr p1 = L_Busmon_New ();
               p1->lpdu = L_Data_to_CM_TP1 (c);
               recv_L_Busmonitor (std::move(p1));
             }
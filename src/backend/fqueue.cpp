@@ -21,6 +21,7 @@
 
 QueueFilter::QueueFilter (const LinkConnectPtr_& c, IniSectionPtr& s) : Filter(c,s)
 {
+  trigger.set (evloop);
   trigger.set<QueueFilter, &QueueFilter::trigger_cb>(this);
   trigger.start();
   state = Q_DOWN;
@@ -46,7 +47,7 @@ QueueFilter::setup()
     }
   if (!Filter::setup())
     return false;
-  // XXX options?
+  buf.weight = cfg->value("prio-weight", (int)buf.weight);
   return true;
 }
 
@@ -69,6 +70,7 @@ void
 QueueFilter::stopped(bool err)
 {
   buf.clear();
+  buf.traceStats (t, "queue");
   state = Q_DOWN;
   Filter::stopped(err);
 }
@@ -27,7 +27,7 @@ supports it.
 #ifndef FQUEUE_H
 #define FQUEUE_H
 #include "link.h"
-#include "queue.h"
+#include "prioqueue.h"
 
 enum QSTATE
 {
@@ -39,7 +39,7 @@ enum QSTATE
 
 FILTER(QueueFilter,queue)
 {
-  Queue < LDataPtr > buf;
+  LDataQueue buf;
   enum QSTATE state;
   ev::async trigger;
   void trigger_cb (ev::async &w, int revents);
@@ -164,9 +164,12 @@ FT12wrap::start()
 void
 FT12wrap::setup_buffers()
 {
+  timer.set (evloop);
   timer.set <FT12wrap,&FT12wrap::timer_cb> (this);
+  sendtimer.set (evloop);
   sendtimer.set <FT12wrap,&FT12wrap::sendtimer_cb> (this);
 
+  trigger.set (evloop);
   trigger.set<FT12wrap,&FT12wrap::trigger_cb>(this);
   trigger.start();
 }
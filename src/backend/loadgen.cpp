@@ -0,0 +1,248 @@
+/*
+    EIBD eib bus access and management daemon
+    Copyright (C) 2005-2011 Martin Koegler <mkoegler@auto.tuwien.ac.at>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "loadgen.h"
+
+#include <cstdio>
+
+/** bursts sent per timer callback, at most, when we're behind */
+#define MAX_BURSTS 64
+
+LoadGenDriver::LoadGenDriver (const LinkConnectPtr_& c, IniSectionPtr& s) : HWBusDriver(c,s)
+{
+  t->setAuxName("LoadGen");
+  timer.set (evloop);
+  timer.set<LoadGenDriver, &LoadGenDriver::timer_cb>(this);
+}
+
+LoadGenDriver::~LoadGenDriver ()
+{
+  timer.stop();
+}
+
+/** parses "X.Y.Z[:N]" resp. "A/B/C[:N]" */
+bool
+LoadGenDriver::readblock (const char *opt, const std::string& def, bool group,
+                          eibaddr_t& first, int& len)
+{
+  std::string x = cfg->value(opt, def);
+  if (!ParseAddrBlock (x, group, first, len))
+    {
+      ERRORPRINTF (t, E_ERROR | 156, "loadgen: %s: '%s' is not a valid address block. Use %s.",
+                   opt, x, group ? "A/B/C:N" : "X.Y.Z:N");
+      return false;
+    }
+  return true;
+}
+
+bool
+LoadGenDriver::setup ()
+{
+  if (!HWBusDriver::setup ())
+    return false;
+
+  rate = cfg->value("rate", 100.);
+  int b = cfg->value("burst", 1);
+  if (rate <= 0 || b < 1)
+    {
+      ERRORPRINTF (t, E_ERROR | 156, "loadgen: rate and burst must be >0");
+      return false;
+    }
+  burst = b;
+
+  std::string pattern = cfg->value("pattern", "steady");
+  if (pattern == "steady")
+    poisson = false;
+  else if (pattern == "poisson")
+    poisson = true;
+  else
+    {
+      ERRORPRINTF (t, E_ERROR | 156, "loadgen: pattern must be 'steady' or 'poisson', not '%s'", pattern);
+      return false;
+    }
+
+  int n = cfg->value("count", 0);
+  count = n > 0 ? n : 0;
+  duration = cfg->value("duration", 0.);
+
+  if (!readblock ("source", "15.15.1:16", false, src_first, src_len))
+    return false;
+  if (!readblock ("groups", "1/0/0:256", true, ga_first, ga_len))
+    return false;
+  if (!readblock ("individual", "15.14.1:16", false, ia_first, ia_len))
+    return false;
+  group_ratio = cfg->value("group-ratio", 1.);
+
+  int smin = cfg->value("size-min", 2);
+  int smax = cfg->value("size-max", smin);
+  if (smin < 2 || smax < smin || smax > 254)
+    {
+      ERRORPRINTF (t, E_ERROR | 156, "loadgen: need 2 <= size-min <= size-max <= 254");
+      return false;
+    }
+  size_min = smin;
+  size_max = smax;
+
+  prio[PRIO_SYSTEM] = cfg->value("prio-system", 0.);
+  prio[PRIO_URGENT] = cfg->value("prio-urgent", 0.);
+  prio[PRIO_NORMAL] = cfg->value("prio-normal", 0.);
+  prio[PRIO_LOW] = cfg->value("prio-low", 1.);
+  float psum = 0;
+  for (int i = 0; i < 4; i++)
+    {
+      if (prio[i] < 0)
+        psum = -1;
+      if (psum >= 0)
+        psum += prio[i];
+    }
+  if (psum <= 0)
+    {
+      ERRORPRINTF (t, E_ERROR | 156, "loadgen: priority weights must be >=0, and not all zero");
+      return false;
+    }
+  for (int i = 0; i < 4; i++)
+    prio[i] /= psum;
+
+  rng.seed (cfg->value("seed", 1));
+  return true;
+}
+
+LDataPtr
+LoadGenDriver::make_frame ()
+{
+  std::uniform_real_distribution<float> u01;
+  LDataPtr l = L_Data_New ();
+
+  l->source_address = src_first + rng() % src_len;
+  if (u01(rng) < group_ratio)
+    {
+      l->address_type = GroupAddress;
+      l->destination_address = ga_first + rng() % ga_len;
+    }
+  else
+    {
+      l->address_type = IndividualAddress;
+      l->destination_address = ia_first + rng() % ia_len;
+    }
+
+  float p = u01(rng);
+  int i = 0;
+  while (i < 3 && p >= prio[i])
+    p -= prio[i++];
+  l->priority = EIB_Priority(i);
+
+  // A_GroupValue_Write with a random value
+  unsigned int len = size_min + rng() % (size_max - size_min + 1);
+  l->lsdu.resize (len);
+  l->lsdu[0] = 0x00;
+  l->lsdu[1] = 0x80;
+  if (len == 2)
+    l->lsdu[1] |= rng() & 0x3f;
+  for (unsigned int j = 2; j < len; j++)
+    l->lsdu[j] = rng();
+
+  L_Data_Stamp (*l);
+  return l;
+}
+
+void
+LoadGenDriver::start ()
+{
+  t_begin = t_start = getMonotonicTime ();
+  sent = 0;
+  sent_total = 0;
+  timer.start (0, 0);
+  HWBusDriver::start ();
+}
+
+void
+LoadGenDriver::stop (bool err)
+{
+  if (timer.is_active ())
+    finish ();
+  HWBusDriver::stop (err);
+}
+
+void
+LoadGenDriver::next_burst ()
+{
+  unsigned int n = burst;
+  if (count && count - sent_total < n)
+    n = count - sent_total;
+  for (unsigned int i = 0; i < n; i++)
+    recv_L_Data (make_frame ());
+  sent += n;
+  sent_total += n;
+}
+
+void
+LoadGenDriver::timer_cb (ev::timer &, int)
+{
+  timestamp_t now = getMonotonicTime ();
+  float delay;
+
+  if (poisson)
+    {
+      next_burst ();
+      std::exponential_distribution<float> gap (rate / burst);
+      delay = gap (rng);
+    }
+  else
+    {
+      // Send whatever is due, but don't try to catch up after a stall.
+      timestamp_t due = t_start + (timestamp_t)(sent * 1000000. / rate);
+      if (now - due > 1000000)
+        {
+          t_start = now;
+          sent = 0;
+        }
+      int i = 0;
+      do
+        {
+          next_burst ();
+          due = t_start + (timestamp_t)(sent * 1000000. / rate);
+        }
+      while (due <= now && ++i < MAX_BURSTS
+             && !(count && sent_total >= count));
+      delay = (due - now) / 1000000.;
+    }
+
+  if ((count && sent_total >= count)
+      || (duration > 0 && now + delay * 1000000 - t_begin > duration * 1000000))
+    {
+      finish ();
+      return;
+    }
+  timer.start (delay > 0 ? delay : 0, 0);
+}
+
+void
+LoadGenDriver::finish ()
+{
+  timer.stop ();
+  float secs = (getMonotonicTime () - t_begin) / 1000000.;
+  ERRORPRINTF (t, E_INFO | 157, "loadgen: sent %lu frames in %.3f sec, %.0f/sec",
+               sent_total, secs, secs > 0 ? sent_total / secs : 0.);
+}
+
+void
+LoadGenDriver::send_L_Data (LDataPtr)
+{
+  send_Next ();
+}
@@ -0,0 +1,87 @@
+/*
+    EIBD eib bus access and management daemon
+    Copyright (C) 2005-2011 Martin Koegler <mkoegler@auto.tuwien.ac.at>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+/**
+
+This module implements a driver which generates synthetic traffic, for
+benchmarking knxd without a bus.
+
+Frames are emitted in bursts, so that their average rate is as
+configured. Addresses, priorities and APDU lengths are drawn at random
+from the configured ranges and weights.
+
+Frames sent to this driver are discarded.
+*/
+
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+#include <random>
+
+#include "link.h"
+
+DRIVER(LoadGenDriver,loadgen)
+{
+  /** frames per second, on average */
+  float rate;
+  /** frames per burst */
+  unsigned int burst;
+  /** exponentially distributed gaps between bursts? */
+  bool poisson;
+  /** stop after this many frames / seconds, if >0 */
+  unsigned long count;
+  float duration;
+
+  /** address ranges to draw from */
+  eibaddr_t src_first, ga_first, ia_first;
+  int src_len, ga_len, ia_len;
+  /** fraction of group-addressed frames */
+  float group_ratio;
+  /** APDU length */
+  unsigned int size_min, size_max;
+  /** weights of PRIO_SYSTEM … PRIO_LOW */
+  float prio[4];
+
+  std::mt19937 rng;
+  bool readblock (const char *opt, const std::string& def, bool group,
+                  eibaddr_t& first, int& len);
+  LDataPtr make_frame ();
+
+  ev::timer timer;
+  void timer_cb (ev::timer &w, int revents);
+  void next_burst ();
+  /** when we started, and how many frames we sent since */
+  timestamp_t t_begin;
+  unsigned long sent_total = 0;
+  /** the same, for pacing: reset after a stall */
+  timestamp_t t_start;
+  unsigned long sent;
+  void finish ();
+
+public:
+  LoadGenDriver (const LinkConnectPtr_& c, IniSectionPtr& s);
+  virtual ~LoadGenDriver ();
+
+  virtual bool setup ();
+  virtual void start ();
+  virtual void stop (bool err);
+  virtual void send_L_Data (LDataPtr l);
+};
+
+#endif
@@ -70,6 +70,7 @@ NatL2Filter::send_L_Data (LDataPtr  l)
   /* Sending a packet to this interface: record address pair, clear source */
   if (l->address_type == IndividualAddress)
     addReverseAddress (l->source_address, l->destination_address);
+  L_Data_Unshare (l);
   l->source_address = addr;
   Filter::send_L_Data (std::move(l));
 }
@@ -85,7 +86,10 @@ NatL2Filter::recv_L_Data (LDataPtr  l)
       return;
     }
   if (l->address_type == IndividualAddress)
-    l->destination_address = getDestinationAddress (l->source_address);
+    {
+      L_Data_Unshare (l);
+      l->destination_address = getDestinationAddress (l->source_address);
+    }
   Filter::recv_L_Data (std::move(l));
 }
 
@@ -150,6 +154,7 @@ MapL2Filter::send_L_Data (LDataPtr  l)
   /* Sending a packet to this interface: reverse-lookup real destination from source */
   if (l->address_type == IndividualAddress)
     {
+      L_Data_Unshare (l);
       l->destination_address = getDestinationAddress (l->source_address);
       if (l->destination_address == 0)
         l->destination_address = addr;
@@ -164,6 +169,7 @@ MapL2Filter::recv_L_Data (LDataPtr  l)
   /* Receiving a packet from this interface: record address pair, clear source */
   if (l->address_type == IndividualAddress)
     addReverseAddress (l->source_address, l->destination_address);
+  L_Data_Unshare (l);
   l->source_address = addr;
   Filter::recv_L_Data (std::move(l));
 }
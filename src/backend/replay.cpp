@@ -0,0 +1,256 @@
+/*
+    EIBD eib bus access and management daemon
+    Copyright (C) 2005-2011 Martin Koegler <mkoegler@auto.tuwien.ac.at>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "replay.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "cm_tp1.h"
+#include "router.h"
+
+/** frames injected per timer callback, at most */
+#define MAX_BATCH 256
+/** frames which are this late (µs) are counted */
+#define LATE 10000
+
+ReplayDriver::ReplayDriver (const LinkConnectPtr_& c, IniSectionPtr& s) : HWBusDriver(c,s)
+{
+  t->setAuxName("Replay");
+  timer.set (evloop);
+  timer.set<ReplayDriver, &ReplayDriver::timer_cb>(this);
+}
+
+ReplayDriver::~ReplayDriver ()
+{
+  timer.stop();
+}
+
+/** Busmonitor timestamps count seconds in the upper 16 bits and
+ * 16-µs ticks in the lower. */
+static timestamp_t
+ts_to_usec (uint32_t ts)
+{
+  return (timestamp_t)(ts >> 16) * 1000000 + (ts & 0xffff) * 16;
+}
+
+bool
+ReplayDriver::load (const std::string& file)
+{
+  std::ifstream in (file);
+  if (!in)
+    {
+      ERRORPRINTF (t, E_ERROR | 159, "replay: %s: %s", file, strerror(errno));
+      return false;
+    }
+
+  std::string line;
+  bool have_ts = false;
+  uint32_t prev_ts = 0;
+  timestamp_t now = 0;
+  skipped = 0;
+  while (std::getline (in, line))
+    {
+      const char *p = line.c_str();
+      while (*p == ' ' || *p == '\t')
+        p++;
+      if (!*p || *p == '#' || !strncmp (p, "TS-Base:", 8))
+        continue;
+
+      // "(status, timestamp) " from busmonitor3
+      if (*p == '(')
+        {
+          unsigned int st, ts;
+          int n = 0;
+          if (sscanf (p, "(%u, %x)%n", &st, &ts, &n) < 2 || !n)
+            {
+              skipped++;
+              continue;
+            }
+          p += n;
+          if (have_ts)
+            {
+              timestamp_t d = ts_to_usec (ts) - ts_to_usec (prev_ts);
+              if (ts < prev_ts) // wrapped after 18 hours
+                d += (timestamp_t)65536 * 1000000;
+              now += d;
+            }
+          have_ts = true;
+          prev_ts = ts;
+        }
+
+      CArray c;
+      unsigned int b;
+      int n;
+      while (sscanf (p, "%2x%n", &b, &n) == 1)
+        {
+          c.push_back (b);
+          p += n;
+          while (*p == ' ')
+            p++;
+        }
+
+      LDataPtr l = c.size() ? CM_TP1_to_L_Data (c, t) : nullptr;
+      // The bus monitor also records acknowledgements and the like.
+      if (!l || l->getType () != L_Data || !l->valid_checksum)
+        {
+          skipped++;
+          continue;
+        }
+      Frame f;
+      f.at = now;
+      f.l = std::move (l);
+      frames.push_back (std::move (f));
+    }
+
+  if (frames.empty ())
+    {
+      ERRORPRINTF (t, E_ERROR | 159, "replay: %s: no frames", file);
+      return false;
+    }
+  TRACEPRINTF (t, 4, "%s: %zu frames over %.3f sec, %lu lines skipped", file,
+               frames.size(), frames.back().at / 1000000., skipped);
+  return true;
+}
+
+bool
+ReplayDriver::setup ()
+{
+  if (!HWBusDriver::setup ())
+    return false;
+
+  std::string file = cfg->value("file", "");
+  if (!file.size())
+    {
+      ERRORPRINTF (t, E_ERROR | 159, "replay: needs a file= to read");
+      return false;
+    }
+  speed = cfg->value("speed", 1.);
+  if (speed < 0)
+    {
+      ERRORPRINTF (t, E_ERROR | 159, "replay: speed must be >=0");
+      return false;
+    }
+  loop = cfg->value("loop", false);
+  return load (file);
+}
+
+unsigned long
+ReplayDriver::routerDrops ()
+{
+  auto c = conn.lock();
+  if (c == nullptr)
+    return 0;
+  Router& r = static_cast<Router&>(c->router);
+  return r.stats.drop_no_dest + r.stats.drop_not_from_us + r.stats.drop_hop_count
+       + r.stats.drop_not_running + r.queueDrops ();
+}
+
+unsigned long
+ReplayDriver::routerRepeats ()
+{
+  auto c = conn.lock();
+  if (c == nullptr)
+    return 0;
+  Router& r = static_cast<Router&>(c->router);
+  return r.repeatWindow().hits;
+}
+
+void
+ReplayDriver::start ()
+{
+  t_begin = t_pass = getMonotonicTime ();
+  pos = 0;
+  sent = 0;
+  lag_max = 0;
+  late = 0;
+  router_drops = routerDrops ();
+  router_repeats = routerRepeats ();
+  timer.start (0, 0);
+  HWBusDriver::start ();
+}
+
+void
+ReplayDriver::stop (bool err)
+{
+  if (timer.is_active ())
+    finish ();
+  HWBusDriver::stop (err);
+}
+
+void
+ReplayDriver::timer_cb (ev::timer &, int)
+{
+  timestamp_t now = getMonotonicTime ();
+  timestamp_t due = now;
+
+  for (int i = 0; i < MAX_BATCH; i++)
+    {
+      if (pos == frames.size ())
+        {
+          if (!loop)
+            {
+              finish ();
+              return;
+            }
+          pos = 0;
+          t_pass = now;
+        }
+
+      Frame& f = frames[pos];
+      if (speed > 0)
+        {
+          due = t_pass + (timestamp_t)(f.at / speed);
+          if (due > now)
+            break;
+          if (lag_max < now - due)
+            lag_max = now - due;
+          if (now - due > LATE)
+            late++;
+        }
+
+      // the router may modify the frame, so it gets a copy
+      LDataPtr l = L_Data_New (*f.l);
+      L_Data_Stamp (*l);
+      recv_L_Data (std::move (l));
+      pos++;
+      sent++;
+    }
+  timer.start (due > now ? (due - now) / 1000000. : 0, 0);
+}
+
+void
+ReplayDriver::finish ()
+{
+  timer.stop ();
+  float secs = (getMonotonicTime () - t_begin) / 1000000.;
+  ERRORPRINTF (t, E_INFO | 160, "replay: %lu frames in %.3f sec, %.0f/sec; "
+               "%lu late by >%dms, max %lld µs; %lu dropped by the router, "
+               "%lu repeats ignored",
+               sent, secs, secs > 0 ? sent / secs : 0., late, LATE / 1000, lag_max,
+               routerDrops () - router_drops, routerRepeats () - router_repeats);
+}
+
+void
+ReplayDriver::send_L_Data (LDataPtr)
+{
+  send_Next ();
+}
@@ -0,0 +1,84 @@
+/*
+    EIBD eib bus access and management daemon
+    Copyright (C) 2005-2011 Martin Koegler <mkoegler@auto.tuwien.ac.at>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+/**
+
+This module implements a driver which plays back a recorded bus monitor
+capture, as written by "knxtool busmonitor3" or "vbusmonitor3", for
+reproducing real-world load.
+
+Frames are injected with their recorded spacing, optionally sped up, or
+as fast as the router takes them. Lines without a timestamp (as written
+by "busmonitor2") are played back to back.
+
+Frames sent to this driver are discarded.
+*/
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "link.h"
+
+DRIVER(ReplayDriver,replay)
+{
+  struct Frame
+  {
+    /** relative to the first frame, µs */
+    timestamp_t at;
+    LDataPtr l;
+  };
+  std::vector<Frame> frames;
+  /** lines which didn't contain a valid L_Data frame */
+  unsigned long skipped;
+  bool load (const std::string& file);
+
+  /** 0: as fast as possible */
+  float speed;
+  bool loop;
+
+  ev::timer timer;
+  void timer_cb (ev::timer &w, int revents);
+  size_t pos;
+  /** when the current pass started */
+  timestamp_t t_pass;
+
+  /** counters of this replay */
+  timestamp_t t_begin;
+  unsigned long sent;
+  timestamp_t lag_max;
+  unsigned long late;
+  /** the router's and the links' drop counters, and the router's
+   * repeat counter, when we started */
+  unsigned long router_drops;
+  unsigned long router_repeats;
+  unsigned long routerDrops ();
+  unsigned long routerRepeats ();
+  void finish ();
+
+public:
+  ReplayDriver (const LinkConnectPtr_& c, IniSectionPtr& s);
+  virtual ~ReplayDriver ();
+
+  virtual bool setup ();
+  virtual void start ();
+  virtual void stop (bool err);
+  virtual void send_L_Data (LDataPtr l);
+};
+
+#endif
@@ -0,0 +1,116 @@
+/*
+    EIBD eib bus access and management daemon
+    Copyright (C) 2005-2011 Martin Koegler <mkoegler@auto.tuwien.ac.at>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "sink.h"
+
+SinkDriver::SinkDriver (const LinkConnectPtr_& c, IniSectionPtr& s) : HWBusDriver(c,s)
+{
+  t->setAuxName("Sink");
+  timer.set (evloop);
+  timer.set<SinkDriver, &SinkDriver::timer_cb>(this);
+  report_timer.set (evloop);
+  report_timer.set<SinkDriver, &SinkDriver::report_timer_cb>(this);
+}
+
+SinkDriver::~SinkDriver ()
+{
+  timer.stop();
+  report_timer.stop();
+}
+
+bool
+SinkDriver::setup ()
+{
+  if (!HWBusDriver::setup ())
+    return false;
+
+  service_time = cfg->value("service-time", 0.) / 1000.;
+  byte_time = cfg->value("service-time-per-byte", 0.) / 1000.;
+  if (service_time < 0 || byte_time < 0)
+    {
+      ERRORPRINTF (t, E_ERROR | 172, "sink: the service time must be >=0");
+      return false;
+    }
+  interval = cfg->value("report-interval", 10.);
+  return true;
+}
+
+void
+SinkDriver::start ()
+{
+  recent = Counts();
+  total = Counts();
+  recent.since = total.since = getMonotonicTime ();
+  if (interval > 0)
+    report_timer.start (interval, interval);
+  HWBusDriver::start ();
+}
+
+void
+SinkDriver::stop (bool err)
+{
+  timer.stop ();
+  report_timer.stop ();
+  report ("total", total);
+  HWBusDriver::stop (err);
+}
+
+void
+SinkDriver::send_L_Data (LDataPtr l)
+{
+  timestamp_t d = l->ingress ? getMonotonicTime () - l->ingress : -1;
+  Counts *cs[] = { &recent, &total };
+  for (auto c : cs)
+    {
+      c->frames++;
+      c->bytes += l->lsdu.size();
+      if (d >= 0)
+        c->latency.add (d);
+    }
+
+  float delay = service_time + byte_time * l->lsdu.size();
+  if (delay > 0)
+    timer.start (delay, 0);
+  else
+    send_Next ();
+}
+
+void
+SinkDriver::timer_cb (ev::timer &, int)
+{
+  send_Next ();
+}
+
+void
+SinkDriver::report_timer_cb (ev::timer &, int)
+{
+  report ("last", recent);
+  recent = Counts();
+  recent.since = getMonotonicTime ();
+}
+
+void
+SinkDriver::report (const char *what, Counts& c)
+{
+  float secs = (getMonotonicTime () - c.since) / 1000000.;
+  if (secs <= 0)
+    return;
+  ERRORPRINTF (t, E_INFO | 158, "sink: %s %.1f sec: %lu frames %.0f/sec, %lu bytes; latency µs %s",
+               what, secs, c.frames, c.frames / secs, c.bytes, c.latency.text ());
+}
@@ -0,0 +1,68 @@
+/*
+    EIBD eib bus access and management daemon
+    Copyright (C) 2005-2011 Martin Koegler <mkoegler@auto.tuwien.ac.at>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+/**
+
+This module implements a driver which accepts frames like a slow bus
+would, for benchmarking knxd without a bus.
+
+Each frame keeps the driver busy for the configured service time. The
+driver periodically logs its throughput and how long the frames it got
+took to get here, measured from their arrival at knxd.
+*/
+
+#ifndef SINK_H
+#define SINK_H
+
+#include "histogram.h"
+#include "link.h"
+
+DRIVER(SinkDriver,sink)
+{
+  /** per frame, and per APDU octet, in seconds */
+  float service_time;
+  float byte_time;
+  ev::timer timer;
+  void timer_cb (ev::timer &w, int revents);
+
+  float interval;
+  ev::timer report_timer;
+  void report_timer_cb (ev::timer &w, int revents);
+
+  /** since the last report, and since the start */
+  struct Counts
+  {
+    timestamp_t since = 0;
+    unsigned long frames = 0;
+    unsigned long bytes = 0;
+    LatencyHistogram latency;
+  } recent, total;
+  void report (const char *what, Counts& c);
+
+public:
+  SinkDriver (const LinkConnectPtr_& c, IniSectionPtr& s);
+  virtual ~SinkDriver ();
+
+  virtual bool setup ();
+  virtual void start ();
+  virtual void stop (bool err);
+  virtual void send_L_Data (LDataPtr l);
+};
+
+#endif
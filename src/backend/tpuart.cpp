@@ -255,20 +255,23 @@ TPUARTwrap::RecvLPDU (const uint8_t * data, int len)
   t->TracePacket (1, "RecvLP", len, data);
   if (state == T_busmonitor)
     {
-      LBusmonPtr l = LBusmonPtr(new L_Busmon_PDU ());
+      LBusmonPtr l = L_Busmon_New ();
       l->lpdu.set (data, len);
       recv_L_Busmonitor (std::move(l));
     }
   else if (state > T_start)
     {
-      if (LPDUPtr l = CM_TP1_to_L_Data (CArray (data, len), t))
+      if (LDataPtr l = CM_TP1_to_L_Data (CArray (data, len), t))
         {
           if (l->getType () != L_Data)
             TRACEPRINTF (t, 1, "dropping packet: type %d", l->getType ());
           else
             {
-              if (((L_Data_PDU *)(&*l))->valid_checksum)
-                recv_L_Data (dynamic_unique_cast<L_Data_PDU>(std::move(l)));
+              if (l->valid_checksum)
+                {
+                  L_Data_Stamp (*l);
+                  recv_L_Data (std::move(l));
+                }
               else
                 TRACEPRINTF (t, 1, "dropping packet: checksum invalid");
             }
@@ -282,7 +285,9 @@ TPUARTwrap::RecvLPDU (const uint8_t * data, int len)
 
 TPUARTwrap::TPUARTwrap(LowLevelIface* parent, IniSectionPtr& s, LowLevelDriver* i) : LowLevelFilter(parent,s,i)
 {
+  timer.set (evloop);
   timer.set <TPUARTwrap,&TPUARTwrap::timer_cb> (this);
+  sendtimer.set (evloop);
   sendtimer.set <TPUARTwrap,&TPUARTwrap::sendtimer_cb> (this);
 }
 
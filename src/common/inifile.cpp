@@ -105,7 +105,7 @@ IniSection::value(const std::string& name, double def)
   if (!v.size())
     return def;
   char *pos;
-  int res = std::strtod(v.c_str(), &pos);
+  double res = std::strtod(v.c_str(), &pos);
   if (!*pos)
     return res;
   std::cerr << "Parse error: Not a float: " << name << "=" << v << std::endl;
@@ -306,3 +306,111 @@ IniData::list_unseen(UnseenViewer uv, void *x)
   return res;
 }
 
+
+/** Split a value into the names of the sections it might refer to. */
+static void
+section_refs(const std::string& v, std::set<std::string>& refs)
+{
+  size_t pos = 0;
+  while (true)
+    {
+      size_t comma = v.find(',',pos);
+      std::string name = v.substr(pos,comma-pos);
+      if (name.size())
+        refs.insert(name);
+      if (comma == std::string::npos)
+        break;
+      pos = comma+1;
+    }
+}
+
+static bool
+same_values(const ValueMap& va, const ValueMap& vb, const char *skip)
+{
+  auto ia = va.begin();
+  auto ib = vb.begin();
+  while (true)
+    {
+      if (skip && ia != va.end() && ia->first == skip)
+        ia++;
+      if (skip && ib != vb.end() && ib->first == skip)
+        ib++;
+      if (ia == va.end() || ib == vb.end())
+        return ia == va.end() && ib == vb.end();
+      if (ia->first != ib->first || ia->second.first != ib->second.first)
+        return false;
+      ia++;
+      ib++;
+    }
+}
+
+bool
+IniData::same(IniData& other, const std::string& name, const char *skip)
+{
+  std::set<std::string> seen;
+  return same_(other, name, skip, seen);
+}
+
+bool
+IniData::same_(IniData& other, const std::string& name, const char *skip,
+               std::set<std::string>& seen)
+{
+  if (!seen.insert(name).second)
+    return true;
+
+  // Looking up a section creates it, so a missing section is an empty one.
+  static const ValueMap none;
+  auto a = sections.find(name);
+  auto b = other.sections.find(name);
+  const ValueMap& va = (a != sections.end()) ? a->second.first->values : none;
+  const ValueMap& vb = (b != other.sections.end()) ? b->second.first->values : none;
+  if (!same_values(va, vb, skip))
+    return false;
+
+  std::set<std::string> refs;
+  for (auto& v : va)
+    if (!skip || v.first != skip)
+      section_refs(v.second.first, refs);
+  ITER(r, refs)
+  if (!same_(other, *r, nullptr, seen))
+    return false;
+  return true;
+}
+
+void
+IniData::update(IniData& other)
+{
+  auto i = sections.begin();
+  while (i != sections.end())
+    {
+      if (other.sections.find(i->first) == other.sections.end())
+        i = sections.erase(i);
+      else
+        i++;
+    }
+
+  ITER(j, other.sections)
+  {
+    const ValueMap& vb = j->second.first->values;
+    auto k = sections.find(j->first);
+    if (k == sections.end())
+      k = sections.emplace(j->first, SectionType(nullptr, false)).first;
+    else if (same_values(k->second.first->values, vb, nullptr))
+      continue;
+
+    // values which didn't change keep their "seen" flag
+    auto sec = IniSectionPtr(new IniSection(*this, j->first));
+    for (auto& v : vb)
+      {
+        bool seen = false;
+        if (k->second.first != nullptr)
+          {
+            auto ov = k->second.first->values.find(v.first);
+            if (ov != k->second.first->values.end() && ov->second.first == v.second.first)
+              seen = ov->second.second;
+          }
+        sec->values.emplace(v.first, ValueType(v.second.first, seen));
+      }
+    k->second.first = sec;
+  }
+}
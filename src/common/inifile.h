@@ -27,6 +27,7 @@
 #include "inih.h"
 //#include <unordered_map>
 #include <map>
+#include <set>
 #include <string>
 #include <memory>
 
@@ -77,6 +78,7 @@ public:
   bool list_unseen(UnseenViewer uv, void *user);
 
 private:
+  friend class IniData;
   ValueMap values;
   IniData& parent;
   bool autogenerated; // don't write, ignore readonly
@@ -110,8 +112,24 @@ public:
 
   bool list_unseen(UnseenViewer uv, void *user);
 
+  /**
+   * Compare section @name with the one in @other, including all sections
+   * its values refer to. Entry @skip of the top section is ignored.
+   * This does not create or mark any sections.
+   */
+  bool same(IniData& other, const std::string& name, const char *skip = nullptr);
+
+  /**
+   * Take over the sections of @other. Values which did not change keep
+   * their state; links which hold on to replaced sections are not affected.
+   */
+  void update(IniData& other);
+
 private:
   SectionMap sections;
+
+  bool same_(IniData& other, const std::string& name, const char *skip,
+             std::set<std::string>& seen);
 };
 
 #endif
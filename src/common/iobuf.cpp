@@ -25,6 +25,12 @@
 
 void SendBuf::write(const CArray *data)
 {
+  if (coalescing)
+    {
+      write(data->data(), data->size());
+      delete data;
+      return;
+    }
   if (!ready)
     {
       ssize_t len = ::write(fd, data->data(), data->size());
@@ -45,9 +51,71 @@ void SendBuf::write(const CArray *data)
     }
 }
 
+bool
+SendBuf::write_out()
+{
+  while (outpos < out.size())
+    {
+      ssize_t i = ::write(fd, out.data()+outpos, out.size()-outpos);
+      if (i > 0)
+        outpos += i;
+      else if (i == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+        return false;
+      else
+        break;
+    }
+  if (outpos < out.size())
+    {
+      // More may be appended before the socket drains, so drop what's
+      // been sent once it's the larger part.
+      if (outpos > out.size() / 2)
+        {
+          out.deletepart (0, outpos);
+          outpos = 0;
+        }
+      return true;
+    }
+  out.clear();
+  outpos = 0;
+  return true;
+}
+
+void
+SendBuf::flush_cb (ev::prepare &, int)
+{
+  flush.stop();
+  if (ready)
+    return; // io_cb is waiting to continue
+  if (!write_out())
+    {
+      on_error();
+      return;
+    }
+  if (out.size())
+    {
+      ready = true;
+      io.start();
+    }
+}
+
 void
 SendBuf::io_cb (ev::io &, int)
 {
+  if (coalescing)
+    {
+      if (!write_out())
+        {
+          io.stop();
+          on_error();
+          return;
+        }
+      if (out.size())
+        return;
+      ready = false;
+      io.stop();
+      on_next();
+      return;
+    }
   while (sendbuf || !sendqueue.empty())
     {
       if (sendbuf)
@@ -175,6 +243,11 @@ void
 SendBuf::stop(bool clear)
 {
   io.stop();
+  flush.stop();
+  // The caller is about to close the socket: don't lose a final reply,
+  // like a rejection, which is still waiting for the flush.
+  if (fd >= 0 && out.size())
+    write_out();
   if (clear)
     fd = -1;
 }
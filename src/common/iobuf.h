@@ -43,20 +43,30 @@ public:
 
   SendBuf() {} // dead
 
-  SendBuf(int fd)
+  SendBuf(struct ev_loop *loop, int fd)
   {
-    init(fd);
+    init(loop, fd);
   }
-  void init(int fd)
+  void init(struct ev_loop *loop, int fd)
   {
     assert (this->fd == -1);
     assert (fd >= 0);
     set_non_blocking(fd);
     this->fd = fd;
+    io.set (loop);
     io.set<SendBuf, &SendBuf::io_cb>(this);
+    flush.set (loop);
+    flush.set<SendBuf, &SendBuf::flush_cb>(this);
     on_error.set<SendBuf,&SendBuf::error_cb>(this);
     on_next.set<SendBuf,&SendBuf::next_cb>(this);
   };
+  /** Collect everything written during one loop iteration and send it
+   * with a single write() at the end of the iteration. Good for sockets
+   * with lots of small messages, not for serial lines. */
+  void coalesce()
+  {
+    coalescing = true;
+  }
 
   virtual ~SendBuf()
   {
@@ -74,6 +84,13 @@ public:
 
   void write(const uint8_t *buf, size_t len)
   {
+    if (coalescing)
+      {
+        out.insert(out.end(), buf, buf+len);
+        if (!ready && !flush.is_active())
+          flush.start();
+        return;
+      }
     CArray *data = new CArray(buf, len);
     write(data);
   }
@@ -90,9 +107,18 @@ protected:
   Queue <const CArray *> sendqueue;
   bool ready = false;
 
+  /** coalescing: pending data, and how much of it has been written */
+  bool coalescing = false;
+  CArray out;
+  size_t outpos = 0;
+
 private:
   ev::io io;
   void io_cb (ev::io &w, int revents);
+  ev::prepare flush;
+  void flush_cb (ev::prepare &w, int revents);
+  /** write pending coalesced data. Returns false on error. */
+  bool write_out();
 };
 
 class RecvBuf
@@ -109,16 +135,17 @@ public:
   }
 
   RecvBuf() {} // dead
-  RecvBuf(int fd)
+  RecvBuf(struct ev_loop *loop, int fd)
   {
-    init(fd);
+    init(loop, fd);
   }
-  void init(int fd)
+  void init(struct ev_loop *loop, int fd)
   {
     assert (this->fd == -1);
     assert (fd >= 0);
     set_non_blocking(fd);
     this->fd = fd;
+    io.set (loop);
     io.set<RecvBuf, &RecvBuf::io_cb>(this);
     on_error.set<RecvBuf,&RecvBuf::error_cb>(this);
     on_read.set<RecvBuf,&RecvBuf::recv_cb>(this);
@@ -0,0 +1,158 @@
+/*
+    EIBD eib bus access and management daemon
+    Copyright (C) 2005-2011 Martin Koegler <mkoegler@auto.tuwien.ac.at>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+/** A free list of equally-sized memory blocks.
+ *
+ * There is one pool per thread (and thus per event loop) and tag type;
+ * see local(). The block size is fixed by the first allocation. Blocks
+ * of any other size are passed through to malloc and counted as misses.
+ *
+ * A block may be released by a different thread than the one which
+ * allocated it; it then simply moves to that thread's pool.
+ */
+class BlockPool
+{
+  struct Block
+  {
+    Block *next;
+  };
+
+  Block *free_list = nullptr;
+  size_t size = 0;
+
+public:
+  /** allocations served from the free list */
+  unsigned long hits = 0;
+  /** allocations which had to call malloc */
+  unsigned long misses = 0;
+  /** blocks currently handed out. Signed because a block may be
+   * released by another thread. */
+  long in_use = 0;
+  /** maximum of in_use */
+  long high_water = 0;
+  /** blocks sitting on the free list */
+  size_t cached = 0;
+  /** don't keep more than this many free blocks */
+  size_t max_cached = 1000;
+
+  BlockPool () = default;
+  BlockPool (const BlockPool&) = delete;
+  ~BlockPool ()
+  {
+    while (free_list)
+      {
+        Block *b = free_list;
+        free_list = b->next;
+        free (b);
+      }
+  }
+
+  /** the pool for this thread */
+  template<typename _Tag>
+  static BlockPool& local ()
+  {
+    static thread_local BlockPool pool;
+    return pool;
+  }
+
+  void *alloc (size_t sz)
+  {
+    if (!size && sz >= sizeof(Block))
+      size = sz;
+    void *p;
+    if (sz == size && free_list)
+      {
+        p = free_list;
+        free_list = free_list->next;
+        cached--;
+        hits++;
+      }
+    else
+      {
+        p = malloc (sz);
+        if (!p)
+          throw std::bad_alloc();
+        misses++;
+      }
+    if (++in_use > high_water)
+      high_water = in_use;
+    return p;
+  }
+
+  void release (void *p, size_t sz)
+  {
+    in_use--;
+    if (sz != size || cached >= max_cached)
+      {
+        free (p);
+        return;
+      }
+    Block *b = static_cast<Block *>(p);
+    b->next = free_list;
+    free_list = b;
+    cached++;
+  }
+};
+
+/** Allocator for std::allocate_shared which uses the pool of the tag type.
+ * This puts the object and its reference count into a single pooled block.
+ */
+template<typename _T, typename _Tag = _T>
+struct PoolAllocator
+{
+  using value_type = _T;
+  template<typename _U> struct rebind
+  {
+    using other = PoolAllocator<_U, _Tag>;
+  };
+
+  PoolAllocator () = default;
+  template<typename _U>
+  PoolAllocator (const PoolAllocator<_U, _Tag>&) { }
+
+  _T *allocate (size_t n)
+  {
+    return static_cast<_T *>(BlockPool::local<_Tag>().alloc (n * sizeof(_T)));
+  }
+  void deallocate (_T *p, size_t n)
+  {
+    BlockPool::local<_Tag>().release (p, n * sizeof(_T));
+  }
+};
+
+template<typename _T, typename _U, typename _Tag>
+inline bool operator== (const PoolAllocator<_T,_Tag>&, const PoolAllocator<_U,_Tag>&)
+{
+  return true;
+}
+template<typename _T, typename _U, typename _Tag>
+inline bool operator!= (const PoolAllocator<_T,_Tag>&, const PoolAllocator<_U,_Tag>&)
+{
+  return false;
+}
+
+#endif
@@ -0,0 +1,90 @@
+/*
+    EIBD eib bus access and management daemon
+    Copyright (C) 2005-2011 Martin Koegler <mkoegler@auto.tuwien.ac.at>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef RING_H
+#define RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/** A bounded lock-free queue between exactly one producer thread and
+ * exactly one consumer thread.
+ *
+ * The capacity is rounded up to a power of two. push() fails instead of
+ * blocking when the ring is full; the caller decides what to drop.
+ */
+template<typename _T>
+class SpscRing
+{
+  std::vector<_T> buf;
+  size_t mask;
+
+  /** next slot to read; written by the consumer only */
+  alignas(64) std::atomic<size_t> head;
+  /** next slot to write; written by the producer only */
+  alignas(64) std::atomic<size_t> tail;
+
+public:
+  SpscRing (size_t n) : head(0), tail(0)
+  {
+    size_t sz = 2;
+    while (sz < n)
+      sz <<= 1;
+    buf.resize (sz);
+    mask = sz - 1;
+  }
+  SpscRing (const SpscRing&) = delete;
+
+  size_t capacity () const
+  {
+    return buf.size ();
+  }
+
+  /** An estimate when called from neither side. */
+  size_t size () const
+  {
+    return tail.load (std::memory_order_acquire) - head.load (std::memory_order_acquire);
+  }
+
+  /** producer side */
+  bool push (_T && v)
+  {
+    size_t t = tail.load (std::memory_order_relaxed);
+    if (t - head.load (std::memory_order_acquire) >= buf.size ())
+      return false;
+    buf[t & mask] = std::move (v);
+    tail.store (t + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** consumer side */
+  bool pop (_T & v)
+  {
+    size_t h = head.load (std::memory_order_relaxed);
+    if (h == tail.load (std::memory_order_acquire))
+      return false;
+    v = std::move (buf[h & mask]);
+    head.store (h + 1, std::memory_order_release);
+    return true;
+  }
+};
+
+#endif
@@ -21,11 +21,16 @@
 #define TYPES_H
 
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 
-#include <vector>
-#include <string>
+#include <initializer_list>
+#include <iterator>
 #include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 #include "config.h"
 
@@ -57,56 +62,392 @@ inline unsigned int _min(const unsigned int _a, const unsigned int _b)
 
 using u8vec = std::vector<uint8_t>; // less typing
 
-class CArray : public u8vec
+/** Byte array with inline storage.
+ *
+ * This behaves like a std::vector<uint8_t>, but the first
+ * CArray::inline_size bytes are stored in the object itself, which covers
+ * standard TP1 frames and most CEMI and KNXnet/IP payloads without
+ * touching the heap. Longer content spills over to malloc'd memory.
+ */
+class CArray
 {
+public:
+  static const size_t inline_size = 40;
+
+  using value_type = uint8_t;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using reference = uint8_t&;
+  using const_reference = const uint8_t&;
+  using pointer = uint8_t*;
+  using const_pointer = const uint8_t*;
+  using iterator = uint8_t*;
+  using const_iterator = const uint8_t*;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+  /** like std::vector, don't take (count, value) for a pair of iterators */
+  template<typename _It>
+  using IfIterator = typename std::enable_if<!std::is_integral<_It>::value>::type;
+
+  uint8_t *ptr = buf;
+  uint32_t len = 0;
+  uint32_t cap = inline_size;
+  uint8_t buf[inline_size];
+
+  bool is_inline() const
+  {
+    return ptr == buf;
+  }
+
+  void grow (size_type n)
+  {
+    size_type nc = cap * 2;
+    if (nc < n)
+      nc = n;
+    if (is_inline())
+      {
+        uint8_t *p = (uint8_t *)malloc (nc);
+        if (!p)
+          throw std::bad_alloc();
+        memcpy (p, buf, len);
+        ptr = p;
+      }
+    else
+      {
+        uint8_t *p = (uint8_t *)realloc (ptr, nc);
+        if (!p)
+          throw std::bad_alloc();
+        ptr = p;
+      }
+    cap = nc;
+  }
+
+  void take (CArray& a)
+  {
+    if (a.is_inline())
+      {
+        memcpy (buf, a.buf, a.len);
+        ptr = buf;
+        cap = inline_size;
+      }
+    else
+      {
+        ptr = a.ptr;
+        cap = a.cap;
+        a.ptr = a.buf;
+        a.cap = inline_size;
+      }
+    len = a.len;
+    a.len = 0;
+  }
+
+  /** make room for @n bytes at @off, return pointer to the gap */
+  uint8_t *open (size_type off, size_type n)
+  {
+    if (len + n > cap)
+      grow (len + n);
+    memmove (ptr + off + n, ptr + off, len - off);
+    len += n;
+    return ptr + off;
+  }
+
 public:
   /** start with various initializers */
-  CArray() : u8vec() { }
-  CArray(const CArray& __str, size_type __pos) : u8vec(_sub(__pos,__str.size()))
+  CArray() { }
+  explicit CArray(size_type n)
+  {
+    resize (n);
+  }
+  CArray(std::initializer_list<uint8_t> il)
+  {
+    set (il.begin(), il.size());
+  }
+  template<typename _It, typename = IfIterator<_It> >
+  CArray(_It first, _It last)
+  {
+    insert (end(), first, last);
+  }
+  CArray(const CArray& a)
+  {
+    set (a.data(), a.size());
+  }
+  CArray(CArray&& a)
+  {
+    take (a);
+  }
+  CArray(const CArray& __str, size_type __pos)
+  {
+    resize (_sub(__pos,__str.size()));
+    memcpy (ptr, __str.data()+__pos, len);
+  }
+  CArray(const CArray& __str, size_type __pos, size_type __n)
+  {
+    resize (_min(__n,_sub(__pos,__str.size())));
+    memcpy (ptr, __str.data()+__pos, len);
+  }
+  CArray(const uint8_t *__str, size_type __pos, size_type __n)
+  {
+    set (__str + __pos, __n);
+  }
+  CArray(const uint8_t *__str, size_type __n)
+  {
+    set (__str, __n);
+  }
+  ~CArray()
+  {
+    if (!is_inline())
+      free (ptr);
+  }
+
+  CArray& operator= (const CArray& a)
+  {
+    if (&a != this)
+      set (a.data(), a.size());
+    return *this;
+  }
+  CArray& operator= (CArray&& a)
+  {
+    if (&a != this)
+      {
+        if (!is_inline())
+          free (ptr);
+        take (a);
+      }
+    return *this;
+  }
+
+  /* std::vector API */
+  size_type size() const
+  {
+    return len;
+  }
+  bool empty() const
+  {
+    return len == 0;
+  }
+  size_type capacity() const
+  {
+    return cap;
+  }
+  uint8_t *data()
+  {
+    return ptr;
+  }
+  const uint8_t *data() const
+  {
+    return ptr;
+  }
+  iterator begin()
+  {
+    return ptr;
+  }
+  iterator end()
+  {
+    return ptr + len;
+  }
+  const_iterator begin() const
+  {
+    return ptr;
+  }
+  const_iterator end() const
+  {
+    return ptr + len;
+  }
+  const_iterator cbegin() const
+  {
+    return ptr;
+  }
+  const_iterator cend() const
+  {
+    return ptr + len;
+  }
+  reverse_iterator rbegin()
+  {
+    return reverse_iterator(end());
+  }
+  reverse_iterator rend()
+  {
+    return reverse_iterator(begin());
+  }
+  const_reverse_iterator rbegin() const
+  {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const
+  {
+    return const_reverse_iterator(begin());
+  }
+  const_reverse_iterator crbegin() const
+  {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator crend() const
+  {
+    return const_reverse_iterator(begin());
+  }
+  uint8_t& operator[] (size_type i)
   {
-    CArray::iterator j = this->begin();
-    const uint8_t *str = __str.data()+__pos;
-    for(unsigned int i = this->size(); i > 0; i--,j++)
-      *j = *str++;
+    return ptr[i];
   }
-  CArray(const CArray& __str, size_type __pos, size_type __n) : u8vec(_min(__n,_sub(__pos,__str.size())))
+  const uint8_t& operator[] (size_type i) const
   {
-    CArray::iterator j = this->begin();
-    const uint8_t *str = __str.data()+__pos;
-    while(j != this->end())
-      *j++ = *str++;
+    return ptr[i];
   }
-  CArray(const uint8_t *__str, size_type __pos, size_type __n) : u8vec(__n)
+  uint8_t& front()
   {
-    CArray::iterator j = this->begin();
-    __str += __pos;
-    for(unsigned int i = __pos; j != this->end(); i++,j++)
-      *j = *__str++;
+    return ptr[0];
   }
-  CArray(const uint8_t *__str, size_type __n) : u8vec(__n)
+  const uint8_t& front() const
   {
-    CArray::iterator j = this->begin();
-    while(j != this->end())
-      *j++ = *__str++;
+    return ptr[0];
+  }
+  uint8_t& back()
+  {
+    return ptr[len-1];
+  }
+  const uint8_t& back() const
+  {
+    return ptr[len-1];
+  }
+
+  void reserve (size_type n)
+  {
+    if (n > cap)
+      grow (n);
+  }
+  void resize (size_type n, uint8_t v = 0)
+  {
+    if (n > cap)
+      grow (n);
+    if (n > len)
+      memset (ptr + len, v, n - len);
+    len = n;
+  }
+  void clear()
+  {
+    len = 0;
+  }
+  void push_back (uint8_t v)
+  {
+    if (len == cap)
+      grow (len + 1);
+    ptr[len++] = v;
+  }
+  void pop_back()
+  {
+    len--;
   }
 
+  iterator insert (const_iterator pos, uint8_t v)
+  {
+    uint8_t *p = open (pos - ptr, 1);
+    *p = v;
+    return p;
+  }
+  iterator insert (const_iterator pos, size_type n, uint8_t v)
+  {
+    uint8_t *p = open (pos - ptr, n);
+    memset (p, v, n);
+    return p;
+  }
+  iterator insert (const_iterator pos, const uint8_t *first, const uint8_t *last)
+  {
+    size_type off = pos - ptr;
+    size_type n = last - first;
+    if (first >= ptr && first < ptr + len)
+      {
+        // inserting part of ourselves
+        CArray tmp (first, n);
+        return insert (ptr + off, tmp.begin(), tmp.end());
+      }
+    uint8_t *p = open (off, n);
+    if (n)
+      memcpy (p, first, n);
+    return p;
+  }
+  iterator insert (const_iterator pos, uint8_t *first, uint8_t *last)
+  {
+    return insert (pos, (const uint8_t *)first, (const uint8_t *)last);
+  }
+  template<typename _It, typename = IfIterator<_It> >
+  iterator insert (const_iterator pos, _It first, _It last)
+  {
+    size_type off = pos - ptr;
+    uint8_t *p = open (off, std::distance (first, last));
+    for (uint8_t *q = p; first != last; ++first)
+      *q++ = *first;
+    return p;
+  }
+
+  iterator erase (const_iterator first, const_iterator last)
+  {
+    size_type off = first - ptr;
+    size_type n = last - first;
+    memmove (ptr + off, ptr + off + n, len - off - n);
+    len -= n;
+    return ptr + off;
+  }
+  iterator erase (const_iterator pos)
+  {
+    return erase (pos, pos + 1);
+  }
+
+  template<typename _It, typename = IfIterator<_It> >
+  void assign (_It first, _It last)
+  {
+    clear();
+    insert (end(), first, last);
+  }
+  void assign (size_type n, uint8_t v)
+  {
+    clear();
+    resize (n, v);
+  }
+
+  void swap (CArray& a)
+  {
+    CArray tmp (std::move(a));
+    a = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  bool operator== (const CArray& a) const
+  {
+    return len == a.len && (len == 0 || !memcmp (ptr, a.ptr, len));
+  }
+  bool operator!= (const CArray& a) const
+  {
+    return !(*this == a);
+  }
+  bool operator< (const CArray& a) const
+  {
+    int r = memcmp (ptr, a.ptr, _min(len, a.len));
+    return r < 0 || (r == 0 && len < a.len);
+  }
+
+  /* CArray API */
+
   /** set me to a C array */
   void set (const uint8_t *elem, unsigned cnt)
   {
-    this->resize(cnt);
-    CArray::iterator j = this->begin();
-    while(j != this->end())
-      *j++ = *elem++;
+    if (cnt > cap)
+      {
+        // don't copy the old content
+        len = 0;
+        grow (cnt);
+      }
+    if (cnt)
+      memmove (ptr, elem, cnt);
+    len = cnt;
   }
 
   /** copy content. Should be equivalent to operator= */
   void set (const CArray & a)
   {
-    this->resize(a.size());
-    CArray::const_iterator i = a.begin();
-    CArray::iterator j = this->begin();
-    while (i != a.end())
-      *j++ = *i++;
+    if (&a != this)
+      set (a.data(), a.size());
   }
 
   /**
@@ -119,10 +460,8 @@ public:
   {
     if (cnt + start > size())
       resize (cnt + start);
-
-    CArray::iterator i = this->begin()+start;
-    while(cnt--)
-      *i++ = *elem++;
+    if (cnt)
+      memmove (ptr + start, elem, cnt);
   }
 
   /** setpart for a string. This copies the terminal null character, */
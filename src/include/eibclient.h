@@ -853,6 +853,22 @@ int EIB_Cache_Read_Sync (EIBConnection * con, eibaddr_t dest, eibaddr_t * src,
 int EIB_Cache_Read (EIBConnection * con, eibaddr_t dest,
                     eibaddr_t * src, int max_len, uint8_t * buf);
 
+/** Returns the cached values of all group addresses in a list of ranges,
+ * without sending A_GroupValue_Read requests
+ * \param con eibd connection
+ * \param start first group address to return (use 0 for the first request)
+ * \param age if non-zero, skip values older than age seconds
+ * \param ranges_len length of ranges
+ * \param ranges ascending list of ranges, 4 bytes (first and last group address) each; an empty list (ranges must not be NULL) means all group addresses
+ * \param max_len buffer size, at most 65535
+ * \param buf buffer for the entries: source address (2 bytes), group address (2 bytes), age in seconds (2 bytes), APDU length (1 byte), APDU
+ * \param next group address for the next request, 0 if there are no more entries
+ * \return -1 if error (ENODEV=group cache not enabled), else number of bytes read
+ */
+int EIB_Cache_ReadBulk (EIBConnection * con, eibaddr_t start, uint16_t age,
+                        int ranges_len, const uint8_t * ranges,
+                        int max_len, uint8_t * buf, eibaddr_t * next);
+
 /** Returns a list of the last updates in the groupcache
  * \param con eibd connection
  * \param start start position (use 0 for first request)
@@ -869,6 +885,16 @@ int EIB_Cache_LastUpdates2 (EIBConnection * con, uint32_t start,
                             uint8_t timeout, int max_len, uint8_t * buf,
                             uint32_t * end);
 
+/** Returns knxd's runtime counters, as text: one line for the router
+ * and one per link, each with space-separated name=value pairs.
+ * \param con eibd connection
+ * \param flags 1: include the links of connected clients
+ * \param max_len buffer size
+ * \param buf buffer for the text (not NUL-terminated)
+ * \return -1 if error, else number of bytes read
+ */
+int EIB_Stats (EIBConnection * con, uint8_t flags, int max_len, uint8_t * buf);
+
 /** Enable Group Cache - asynchronous.
  * \param con eibd connection
  * \return 0 if started, -1 if error
@@ -919,6 +945,23 @@ int EIB_Cache_Read_async (EIBConnection * con, eibaddr_t dest,
                           eibaddr_t * src, int max_len, uint8_t * buf);
 
 
+/** Returns the cached values of all group addresses in a list of ranges,
+ * without sending A_GroupValue_Read requests - asynchronous
+ * \param con eibd connection
+ * \param start first group address to return (use 0 for the first request)
+ * \param age if non-zero, skip values older than age seconds
+ * \param ranges_len length of ranges
+ * \param ranges ascending list of ranges, 4 bytes (first and last group address) each; an empty list (ranges must not be NULL) means all group addresses
+ * \param max_len buffer size, at most 65535
+ * \param buf buffer for the entries: source address (2 bytes), group address (2 bytes), age in seconds (2 bytes), APDU length (1 byte), APDU
+ * \param next group address for the next request, 0 if there are no more entries
+ * \return 0 if started, -1 if error
+ */
+int EIB_Cache_ReadBulk_async (EIBConnection * con, eibaddr_t start,
+                              uint16_t age, int ranges_len,
+                              const uint8_t * ranges, int max_len,
+                              uint8_t * buf, eibaddr_t * next);
+
 /** Returns a list of the last updates in the groupcache - asynchronous.
  * \param con eibd connection
  * \param start start position (use 0 for first request)
@@ -935,6 +978,15 @@ int EIB_Cache_LastUpdates2_async (EIBConnection * con, uint32_t start,
                                   uint8_t timeout, int max_len, uint8_t * buf,
                                   uint32_t * end);
 
+/** Returns knxd's runtime counters - asynchronous.
+ * \param con eibd connection
+ * \param flags 1: include the links of connected clients
+ * \param max_len buffer size
+ * \param buf buffer for the text
+ * \return 0 if started, -1 if error
+ */
+int EIB_Stats_async (EIBConnection * con, uint8_t flags, int max_len, uint8_t * buf);
+
 
 #ifdef __cplusplus
 }
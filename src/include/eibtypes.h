@@ -88,5 +88,9 @@
 #define EIB_CACHE_LAST_UPDATES          0x0076
 #define EIB_CACHE_LAST_UPDATES_2        0x0077
 // like last_updates but 32bit counter
+#define EIB_STATS                       0x0078
+// runtime counters, as text
+#define EIB_CACHE_READ_BULK             0x0079
+// all cached values of a list of group address ranges
 
 #endif
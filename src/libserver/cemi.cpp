@@ -34,6 +34,7 @@ CEMIDriver::CEMIDriver (LowLevelIface* c, IniSectionPtr& s, LowLevelDriver *i) :
 {
   t->setAuxName("CEMI");
   sendLocal_done.set<CEMIDriver,&CEMIDriver::sendLocal_done_cb>(this);
+  reset_timer.set (evloop);
   reset_timer.set<CEMIDriver,&CEMIDriver::reset_timer_cb>(this);
 }
 
@@ -35,7 +35,7 @@
 #endif
 #include "server.h"
 
-ClientConnection::ClientConnection (NetServerPtr s, int fd) : router(static_cast<Router&>(s->router)), sendbuf(fd),recvbuf(fd)
+ClientConnection::ClientConnection (NetServerPtr s, int fd) : router(static_cast<Router&>(s->router)), sendbuf(s->evloop,fd),recvbuf(s->evloop,fd)
 {
   t = TracePtr(new Trace(*(s->t)));
   t->setAuxName("CConn");
@@ -50,6 +50,7 @@ ClientConnection::ClientConnection (NetServerPtr s, int fd) : router(static_cast
   recvbuf.on_read.set<ClientConnection,&ClientConnection::read_cb>(this);
   recvbuf.on_error.set<ClientConnection,&ClientConnection::error_cb>(this);
   sendbuf.on_error.set<ClientConnection,&ClientConnection::error_cb>(this);
+  sendbuf.coalesce();
 }
 
 ClientConnection::~ClientConnection ()
@@ -244,10 +245,26 @@ ClientConnection::read_cb (uint8_t *buf, size_t len)
     case EIB_CACHE_READ_NOWAIT:
     case EIB_CACHE_LAST_UPDATES:
     case EIB_CACHE_LAST_UPDATES_2:
+    case EIB_CACHE_READ_BULK:
       GroupCacheRequest (SFT, buf,xlen);
       break;
 #endif
 
+    case EIB_STATS:
+    {
+      // flag 1: include the clients' links; flag 2: latency histograms
+      std::string st = router.statsText (xlen > 2 && (buf[2] & 1),
+                                         xlen > 2 && (buf[2] & 2));
+      // the length field has 16 bits
+      if (st.size() > 0xffff - 2)
+        st.resize (0xffff - 2);
+      CArray erg (st.size() + 2);
+      EIBSETTYPE (erg, EIB_STATS);
+      erg.setpart ((const uint8_t *) st.data(), 2, st.size());
+      sendmessage (erg.size(), erg.data());
+      break;
+    }
+
     case EIB_RESET_CONNECTION:
       sendreject (EIB_RESET_CONNECTION);
       break;
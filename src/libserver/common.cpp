@@ -20,6 +20,7 @@
 #include "common.h"
 
 #include <cstdio>
+#include <time.h>
 #ifdef HAVE_SYS_TIME_H
 #include <sys/time.h>
 #endif
@@ -32,6 +33,14 @@ getTime ()
   return ((timestamp_t) t.tv_sec) * 1000000 + ((timestamp_t) t.tv_usec);
 }
 
+timestamp_t
+getMonotonicTime ()
+{
+  struct timespec t;
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return ((timestamp_t) t.tv_sec) * 1000000 + ((timestamp_t) t.tv_nsec / 1000);
+}
+
 std::string
 FormatEIBAddr (eibaddr_t addr)
 {
@@ -66,6 +75,22 @@ FormatEIBKey (eibkey_type key)
   return buf;
 }
 
+bool
+ParseAddrBlock (const std::string& s, bool group, eibaddr_t& first, int& len)
+{
+  int a, b, c, n = 1;
+  if (sscanf (s.c_str(), group ? "%d/%d/%d:%d" : "%d.%d.%d:%d", &a, &b, &c, &n) < 3)
+    return false;
+  if (a < 0 || a > (group ? 0x1f : 0x0f) || b < 0 || b > (group ? 0x07 : 0x0f)
+      || c < 0 || c > 0xff)
+    return false;
+  first = group ? (a << 11) | (b << 8) | c : (a << 12) | (b << 8) | c;
+  if (n < 1 || first + n > 0x10000)
+    return false;
+  len = n;
+  return true;
+}
+
 void
 addHex (std::string & s, const uint8_t c)
 {
@@ -56,6 +56,8 @@ void add16Hex (std::string & s, const uint16_t c);
 
 /** get current time */
 timestamp_t getTime ();
+/** get a timestamp which is not affected by clock changes */
+timestamp_t getMonotonicTime ();
 
 /** formats an EIB individual address */
 std::string FormatEIBAddr (const eibaddr_t a);
@@ -66,6 +68,10 @@ std::string FormatDomainAddr (const domainaddr_t addr);
 /** formats an EIB key */
 std::string FormatEIBKey (const eibkey_type addr);
 
+/** parses an address block "X.Y.Z[:N]", or "A/B/C[:N]" if @group is set
+ * @return false if it's malformed, empty, or runs past the last address */
+bool ParseAddrBlock (const std::string& s, bool group, eibaddr_t& first, int& len);
+
 /** libev */
 #if EV_MULTIPLICITY
 using LOOP_RESULT = struct ev_loop *;
@@ -67,8 +67,8 @@ const
   return c;
 }
 
-EIBNetIPSocket::EIBNetIPSocket (struct sockaddr_in bindaddr, bool reuseaddr,
-                                TracePtr tr, SockMode mode)
+EIBNetIPSocket::EIBNetIPSocket (struct ev_loop *loop, struct sockaddr_in bindaddr,
+                                bool reuseaddr, TracePtr tr, SockMode mode)
 {
   int i;
   t = tr;
@@ -80,7 +80,9 @@ EIBNetIPSocket::EIBNetIPSocket (struct sockaddr_in bindaddr, bool reuseaddr,
   memset (&recvaddr2, 0, sizeof (recvaddr2));
   recvall = 0;
 
+  io_send.set (loop);
   io_send.set<EIBNetIPSocket, &EIBNetIPSocket::io_send_cb>(this);
+  io_recv.set (loop);
   io_recv.set<EIBNetIPSocket, &EIBNetIPSocket::io_recv_cb>(this);
   on_recv.set<EIBNetIPSocket, &EIBNetIPSocket::recv_cb>(this); // dummy
   on_error.set<EIBNetIPSocket, &EIBNetIPSocket::error_cb>(this); // dummy
@@ -227,24 +229,21 @@ EIBNetIPSocket::Send (EIBNetIPPacket p, struct sockaddr_in addr)
 void
 EIBNetIPSocket::io_send_cb (ev::io &, int)
 {
-  if (send_q.empty ())
-    {
-      io_send.stop();
-      on_next();
-      return;
-    }
-  const struct _EIBNetIP_Send s = send_q.front ();
-  CArray p = s.data.ToPacket ();
-  t->TracePacket (0, "Send", p);
-  int i = sendto (fd, p.data(), p.size(), 0,
-                  (const struct sockaddr *) &s.addr, sizeof (s.addr));
-  if (i > 0)
-    {
-      send_q.get ();
-      send_error = 0;
-    }
-  else
+  // Send as much of the queue as the socket accepts, instead of one
+  // packet per loop iteration.
+  while (!send_q.empty ())
     {
+      const struct _EIBNetIP_Send& s = send_q.front ();
+      CArray p = s.data.ToPacket ();
+      t->TracePacket (0, "Send", p);
+      int i = sendto (fd, p.data(), p.size(), 0,
+                      (const struct sockaddr *) &s.addr, sizeof (s.addr));
+      if (i > 0)
+        {
+          send_q.get ();
+          send_error = 0;
+          continue;
+        }
       if (i == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
         {
           TRACEPRINTF (t, 0, "Send: %s", strerror(errno));
@@ -256,7 +255,10 @@ EIBNetIPSocket::io_send_cb (ev::io &, int)
               on_error();
             }
         }
+      return;
     }
+  io_send.stop();
+  on_next();
 }
 
 void
@@ -442,8 +442,8 @@ public:
   InfoCallback on_error;
   InfoCallback on_next;
 
-  EIBNetIPSocket (struct sockaddr_in bindaddr, bool reuseaddr, TracePtr tr,
-                  SockMode mode = S_RDWR);
+  EIBNetIPSocket (struct ev_loop *loop, struct sockaddr_in bindaddr,
+                  bool reuseaddr, TracePtr tr, SockMode mode = S_RDWR);
   virtual ~EIBNetIPSocket ();
   bool init ();
   void stop(bool err);
@@ -80,7 +80,7 @@ EIBnetDriver::EIBnetDriver (LinkConnectClientPtr c,
       baddr.sin_addr.s_addr = htonl (INADDR_ANY);
       baddr.sin_port = htons (port);
 
-      sock = new EIBNetIPSocket (baddr, 1, t);
+      sock = new EIBNetIPSocket (evloop, baddr, 1, t);
       if (!sock->SetInterface(intf))
         goto err_out;
       if (!sock->init ())
@@ -204,7 +204,7 @@ EIBnetServer::start()
   baddr.sin_addr.s_addr = htonl (INADDR_ANY);
   baddr.sin_port = single_port ? htons(port) : 0;
 
-  sock = new EIBNetIPSocket (baddr, 1, t);
+  sock = new EIBNetIPSocket (evloop, baddr, 1, t);
   if (!sock)
     {
       ERRORPRINTF (t, E_ERROR | 41, "EIBNetIPSocket creation failed");
@@ -334,6 +334,8 @@ rt:
       s->no = 1;
       s->type = type;
       s->nat = r1.nat;
+      if (addr)
+        conn->setAddress(addr);
       if(!conn->setup())
         return -1;
       if(!static_cast<Router &>(router).registerLink(conn, true))
@@ -635,7 +637,10 @@ EIBnetServer::handle_packet (EIBNetIPPacket *p1, EIBNetIPSocket *isock)
       if (!c)
         t->TracePacket (2, "unCEMIable ROUTING_INDICATION", p1->data);
       else if (route)
-        mcast->recv_L_Data (std::move(c));
+        {
+          L_Data_Stamp (*c);
+          mcast->recv_L_Data (std::move(c));
+        }
       goto out;
     }
   if (p1->service == CONNECTIONSTATE_REQUEST)
@@ -934,6 +939,7 @@ void ConnState::tunnel_request(EIBnet_TunnelRequest &r1, EIBNetIPSocket *isock)
       LDataPtr c = CEMI_to_L_Data (r1.CEMI, t);
       if (c)
         {
+          L_Data_Stamp (*c);
           r2.status = 0;
           if (r1.CEMI[0] == 0x11)
             {
@@ -164,6 +164,7 @@ USBDriver::started()
   if (version == vUnknown)
     {
       version = vDiscovery;
+      timeout.set (evloop);
       timeout.set<USBDriver,&USBDriver::timeout_cb>(this);
       is_local = false; // was set by xmit => send_Local
       xmit();
@@ -67,7 +67,7 @@ CEMI_to_L_Data (const CArray & data, TracePtr tr)
       return nullptr;
     }
 
-  LDataPtr c = LDataPtr(new L_Data_PDU ());
+  LDataPtr c = L_Data_New ();
   c->source_address = (data[start + 2] << 8) | (data[start + 3]);
   c->destination_address = (data[start + 4] << 8) | (data[start + 5]);
   c->lsdu.set (data.data() + start + 7, data[6 + start] + 1);
@@ -95,7 +95,7 @@ CEMI_to_Busmonitor (const CArray & data, DriverPtr)
   if (data.size() < 1 + start)
     return nullptr;
 
-  LBusmonPtr c = LBusmonPtr(new L_Busmon_PDU ());
+  LBusmonPtr c = L_Busmon_New ();
   c->lpdu.set (data.data() + start, data.size() - start);
   // TODO add l2 so that we can tell which driver did it
   return c;
@@ -150,7 +150,7 @@ L_Data_ToEMI (uint8_t code, const LDataPtr & l1)
 LDataPtr
 EMI_to_L_Data (const CArray & data, TracePtr)
 {
-  LDataPtr c = LDataPtr(new L_Data_PDU ());
+  LDataPtr c = L_Data_New ();
   unsigned len;
 
   if (data.size() < 8)
@@ -47,6 +47,7 @@ cfgEMIVersion(IniSectionPtr& s)
 
 EMI_Common::EMI_Common (LowLevelIface* c, IniSectionPtr& s, LowLevelDriver *i) : LowLevelFilter(c,s,i)
 {
+  timeout.set (evloop);
   timeout.set<EMI_Common, &EMI_Common::timeout_cb>(this);
   t->setAuxName("EMI_common");
   iface = i;
@@ -194,7 +195,7 @@ EMI_Common::recv_Data(CArray& c)
     }
   else if (c.size() > 4 && c[0] == ind[I_BUSMON] && monitor)
     {
-      LBusmonPtr p = LBusmonPtr(new L_Busmon_PDU ());
+      LBusmonPtr p = L_Busmon_New ();
       p->l_status = c[1];
       p->time_stamp = (c[2] << 24) | (c[3] << 16);
       p->lpdu.set (c.data() + 4, c.size() - 4);
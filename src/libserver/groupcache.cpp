@@ -19,9 +19,60 @@
 
 #include "groupcache.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "apdu.h"
+#include "router.h"
 #include "tpdu.h"
 
+/** the longest the warm-up backs off, seconds */
+#define WARMUP_MAX_WAIT 5.
+/** how long clients' reads may join a warm-up read, seconds */
+#define WARMUP_READ_TIMEOUT 2.
+
+/* The snapshot file: a header, followed by the entries in update order.
+ * Each entry is padded to a multiple of 8 bytes. The file is written in
+ * host byte order; it's not meant to be copied to other systems. */
+
+#define SNAPSHOT_MAGIC "knxdGC\n"
+#define SNAPSHOT_VERSION 1
+
+struct SnapshotHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t count;
+  /** the cache's seq */
+  uint32_t seq;
+  uint32_t reserved;
+};
+
+struct SnapshotEntry
+{
+  int64_t recvtime;
+  uint32_t seq;
+  uint16_t dst;
+  uint16_t src;
+  uint16_t len;
+  uint8_t data[6]; // len bytes, actually
+};
+
+static size_t
+snapshot_entry_size (size_t len)
+{
+  size_t sz = offsetof (SnapshotEntry, data) + len;
+  return (sz + 7) & ~7;
+}
+
 GroupCache::GroupCache (const LinkConnectPtr& c, IniSectionPtr& s)
   : Driver(c,s)
 {
@@ -29,18 +80,24 @@ GroupCache::GroupCache (const LinkConnectPtr& c, IniSectionPtr& s)
   TRACEPRINTF (t, 4, "GroupCacheInit");
   enable = 0;
   remtrigger.set<GroupCache, &GroupCache::remtrigger_cb>(this);
+  snapshot_timer.set<GroupCache, &GroupCache::snapshot_timer_cb>(this);
+  warmup_timer.set<GroupCache, &GroupCache::warmup_timer_cb>(this);
   addr = c->router.addr;
   c->is_local = true;
+  slots.resize(0x10000);
 }
 
 GroupCache::~GroupCache ()
 {
   remtrigger.stop();
-  R_ITER(i,reader)
-  {
-    (*i)->stop(false);
-    delete *i;
-  }
+  snapshot_timer.stop();
+  warmup_timer.stop();
+  while (trackers)
+    trackers->stop(false);
+  while (!waiters.empty())
+    waiters.begin()->second->stop(false);
+  ITER(i,stopped_readers)
+  delete *i;
   TRACEPRINTF (t, 4, "GroupCacheDestroy");
   Clear ();
 }
@@ -52,12 +109,102 @@ GroupCache::setup()
     return false;
   remtrigger.start();
   this->maxsize = cfg->value("max-size", 0xFFFF);
+  snapshot = cfg->value("snapshot", "");
+  snapshot_max_age = cfg->value("snapshot-max-age", 0);
+  snapshot_interval = cfg->value("snapshot-interval", 600.);
+  read_interval = cfg->value("read-interval", 0.) * 1000000;
+  double rt = cfg->value("read-timeout", 0.075);
+  if (rt < 0.001)
+    {
+      ERRORPRINTF (t, E_ERROR | 173, "read-timeout must be at least 0.001");
+      return false;
+    }
+  read_timeout = rt * 1000;
+
+  warmup.clear();
+  if (!readWarmup (cfg->value("warmup", ""), "warmup"))
+    return false;
+  std::string file = cfg->value("warmup-file", "");
+  if (file.size() && !readWarmupFile (file))
+    return false;
+  std::sort (warmup.begin(), warmup.end());
+  warmup.erase (std::unique (warmup.begin(), warmup.end()), warmup.end());
+  warmup_max_age = cfg->value("warmup-max-age", 0);
+  warmup_interval = cfg->value("warmup-interval", 0.);
+  warmup_delay = cfg->value("warmup-delay", 0.2);
+  int q = cfg->value("warmup-max-queue", 0);
+  warmup_max_load = cfg->value("warmup-max-load", 25.);
+  if (warmup_delay <= 0 || q < 0 || warmup_max_load <= 0)
+    {
+      ERRORPRINTF (t, E_ERROR | 171, "cache warm-up: warmup-delay and warmup-max-load must be >0, warmup-max-queue >=0");
+      return false;
+    }
+  warmup_max_queue = q;
+  return true;
+}
+
+/** parses a list of "A/B/C[:N]" */
+bool
+GroupCache::readWarmup (const std::string& list, const std::string& where)
+{
+  size_t pos = 0;
+  while ((pos = list.find_first_not_of (", \t", pos)) != std::string::npos)
+    {
+      size_t end = list.find_first_of (", \t", pos);
+      std::string x = list.substr (pos, end - pos);
+      pos = end;
+
+      eibaddr_t first;
+      int n;
+      if (!ParseAddrBlock (x, true, first, n))
+        {
+          ERRORPRINTF (t, E_ERROR | 171, "cache warm-up: %s: '%s' is not a valid address block. Use A/B/C:N.",
+                       where, x);
+          return false;
+        }
+      for (int i = 0; i < n; i++)
+        warmup.push_back (first + i);
+    }
+  return true;
+}
+
+bool
+GroupCache::readWarmupFile (const std::string& file)
+{
+  std::ifstream in (file);
+  if (!in)
+    {
+      ERRORPRINTF (t, E_ERROR | 171, "cache warm-up: %s: %s", file, strerror(errno));
+      return false;
+    }
+  std::string line;
+  int n = 0;
+  while (std::getline (in, line))
+    {
+      n++;
+      if (!readWarmup (line.substr (0, line.find ('#')), file + ":" + std::to_string (n)))
+        return false;
+    }
   return true;
 }
 
 void
 GroupCache::start()
 {
+  if (snapshot.size() && !snapshot_loaded)
+    {
+      snapshot_loaded = true;
+      loadSnapshot();
+    }
+  if (snapshot.size() && snapshot_interval > 0)
+    snapshot_timer.start(snapshot_interval, snapshot_interval);
+  if (warmup.size())
+    {
+      warmup_pos = 0;
+      warmup_sampled = 0;
+      warmup_wait = warmup_delay;
+      warmup_timer.start(warmup_delay, 0);
+    }
   enable = true;
   Driver::start();
 }
@@ -66,9 +213,239 @@ void
 GroupCache::stop(bool err)
 {
   enable = false;
+  snapshot_timer.stop();
+  warmup_timer.stop();
+  TRACEPRINTF (t, 4, "bus reads: %lu sent, %lu joined a pending one, %lu suppressed",
+               reads_sent, reads_joined, reads_suppressed);
+  if (warmup.size())
+    TRACEPRINTF (t, 4, "cache warm-up: %lu reads, backed off %lu times",
+                 warmup_reads, warmup_backoffs);
+  if (snapshot.size())
+    saveSnapshot();
   Driver::stop(err);
 }
 
+void
+GroupCache::snapshot_timer_cb(ev::timer &, int)
+{
+  if (seq != snapshot_seq)
+    saveSnapshot();
+}
+
+/** Stands for a warm-up read until it's answered, so that clients'
+ * reads of the same address join it instead of sending another one. */
+class GCWarmupRead : protected GroupCacheReader
+{
+  ev::timer timeout;
+public:
+  GCWarmupRead(GroupCache *gc, eibaddr_t addr) : GroupCacheReader(gc, addr)
+  {
+    timeout.set<GCWarmupRead,&GCWarmupRead::timeout_cb>(this);
+    timeout.start(WARMUP_READ_TIMEOUT, 0);
+  }
+  void stop(bool err)
+  {
+    if (stopped)
+      return;
+    timeout.stop();
+    GroupCacheReader::stop(err);
+  }
+private:
+  void updated(GroupCacheEntry &)
+  {
+    stop(false);
+  }
+
+  void timeout_cb(ev::timer &, int)
+  {
+    stop(false);
+  }
+};
+
+void
+GroupCache::warmup_timer_cb(ev::timer &, int)
+{
+  auto c = conn.lock();
+  if (c == nullptr)
+    return;
+  Router& r = static_cast<Router&>(c->router);
+  if (!enable || !r.isRunning())
+    {
+      // wait for the links to come up
+      warmup_sampled = 0;
+      warmup_timer.start(WARMUP_MAX_WAIT, 0);
+      return;
+    }
+
+  // How busy is the bus? The first sample only sets the baseline.
+  timestamp_t now = getMonotonicTime();
+  unsigned long frames;
+  size_t queue;
+  r.busLoad (frames, queue);
+  bool first = !warmup_sampled;
+  float load = 0;
+  if (!first && now > warmup_sampled && frames >= warmup_frames)
+    load = (frames - warmup_frames) * 1000000. / (now - warmup_sampled);
+  warmup_frames = frames;
+  warmup_sampled = now;
+  if (first)
+    {
+      warmup_timer.start(warmup_wait, 0);
+      return;
+    }
+  if (queue > warmup_max_queue || load > warmup_max_load)
+    {
+      TRACEPRINTF (t, 8, "cache warm-up: queue %zu, %.1f frames/sec: waiting", queue, load);
+      warmup_backoffs++;
+      warmup_wait = std::min (warmup_wait * 2, (float)WARMUP_MAX_WAIT);
+      warmup_timer.start(warmup_wait, 0);
+      return;
+    }
+  warmup_wait = std::max (warmup_wait / 2, warmup_delay);
+
+  time_t tnow = time (0);
+  while (warmup_pos < warmup.size())
+    {
+      eibaddr_t ga = warmup[warmup_pos++];
+      const GroupCacheSlot& s = slots[ga];
+      if (s.used && !(warmup_max_age && s.recvtime + warmup_max_age < tnow))
+        continue;
+      // a read is underway
+      if (waiters.find(ga) != waiters.end())
+        continue;
+      TRACEPRINTF (t, 8, "cache warm-up: reading %s", FormatGroupAddr (ga));
+      warmup_reads++;
+      if (sendRead (ga))
+        new GCWarmupRead (this, ga);
+      warmup_timer.start(warmup_wait, 0);
+      return;
+    }
+
+  TRACEPRINTF (t, 4, "cache warm-up: pass done, %lu reads so far, backed off %lu times",
+               warmup_reads, warmup_backoffs);
+  warmup_pos = 0;
+  warmup_sampled = 0;
+  if (warmup_interval > 0)
+    warmup_timer.start(warmup_interval, 0);
+}
+
+void
+GroupCache::loadSnapshot()
+{
+  int fd = open (snapshot.c_str(), O_RDONLY);
+  if (fd < 0)
+    {
+      if (errno != ENOENT)
+        ERRORPRINTF (t, E_WARNING | 168, "cache snapshot %s: %s", snapshot, strerror(errno));
+      return;
+    }
+  struct stat st;
+  if (fstat (fd, &st) < 0 || (size_t)st.st_size < sizeof(SnapshotHeader))
+    {
+      ERRORPRINTF (t, E_WARNING | 168, "cache snapshot %s: too short", snapshot);
+      close (fd);
+      return;
+    }
+  size_t size = st.st_size;
+  void *map = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED)
+    {
+      ERRORPRINTF (t, E_WARNING | 168, "cache snapshot %s: %s", snapshot, strerror(errno));
+      return;
+    }
+
+  const uint8_t *p = (const uint8_t *)map;
+  const uint8_t *end = p + size;
+  const SnapshotHeader *h = (const SnapshotHeader *)p;
+  if (memcmp (h->magic, SNAPSHOT_MAGIC, sizeof(h->magic)) || h->version != SNAPSHOT_VERSION)
+    {
+      ERRORPRINTF (t, E_WARNING | 168, "cache snapshot %s: unknown format", snapshot);
+      munmap (map, size);
+      return;
+    }
+
+  time_t now = time (0);
+  unsigned int loaded = 0, stale = 0;
+  p += sizeof(SnapshotHeader);
+  for (uint32_t i = 0; i < h->count; i++)
+    {
+      const SnapshotEntry *e = (const SnapshotEntry *)p;
+      if (p + offsetof (SnapshotEntry, data) > end
+          || p + snapshot_entry_size (e->len) > end || e->len > 0xFF)
+        {
+          ERRORPRINTF (t, E_WARNING | 168, "cache snapshot %s: truncated", snapshot);
+          break;
+        }
+      p += snapshot_entry_size (e->len);
+
+      if (snapshot_max_age && e->recvtime + snapshot_max_age < now)
+        {
+          stale++;
+          continue;
+        }
+      // entries are in update order, so the oldest are evicted first
+      store (e->dst, e->src, e->data, e->len, e->recvtime, e->seq);
+      loaded++;
+    }
+  // clients may have remembered their position
+  seq = snapshot_seq = h->seq;
+  munmap (map, size);
+  ERRORPRINTF (t, E_INFO | 169, "cache snapshot %s: %u entries loaded, %u expired",
+               snapshot, loaded, stale);
+}
+
+void
+GroupCache::saveSnapshot()
+{
+  std::string tmp = snapshot + ".tmp";
+  FILE *f = fopen (tmp.c_str(), "w");
+  if (f == NULL)
+    {
+      ERRORPRINTF (t, E_WARNING | 170, "cache snapshot %s: %s", tmp, strerror(errno));
+      return;
+    }
+
+  SnapshotHeader h;
+  memset (&h, 0, sizeof(h));
+  memcpy (h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+  h.version = SNAPSHOT_VERSION;
+  h.count = used;
+  h.seq = seq;
+  fwrite (&h, sizeof(h), 1, f);
+
+  std::vector<uint8_t> buf;
+  for (uint32_t i = lru_head; i != GC_NONE; i = slots[i].next)
+    {
+      const GroupCacheSlot& c = slots[i];
+      buf.assign (snapshot_entry_size (c.len), 0);
+      SnapshotEntry *e = (SnapshotEntry *)buf.data();
+      e->recvtime = c.recvtime;
+      e->seq = c.seq;
+      e->dst = i;
+      e->src = c.src;
+      e->len = c.len;
+      memcpy (e->data, slotData (i), c.len);
+      fwrite (buf.data(), buf.size(), 1, f);
+    }
+
+  bool err = ferror (f);
+  if (fclose (f) || err)
+    {
+      ERRORPRINTF (t, E_WARNING | 170, "cache snapshot %s: write error", tmp);
+      ::unlink (tmp.c_str());
+      return;
+    }
+  if (rename (tmp.c_str(), snapshot.c_str()) < 0)
+    {
+      ERRORPRINTF (t, E_WARNING | 170, "cache snapshot %s: %s", snapshot, strerror(errno));
+      ::unlink (tmp.c_str());
+      return;
+    }
+  snapshot_seq = seq;
+  TRACEPRINTF (t, 4, "cache snapshot: %u entries written", h.count);
+}
+
 void
 GroupCache::send_L_Data (LDataPtr lpdu)
 {
@@ -81,29 +458,11 @@ GroupCache::send_L_Data (LDataPtr lpdu)
           if (tpdu1->tsdu.size() >= 2 && !(tpdu1->tsdu[0] & 0x3) &&
               ((tpdu1->tsdu[1] & 0xC0) == 0x40 || (tpdu1->tsdu[1] & 0xC0) == 0x80)) // response or write
             {
-              CacheMap::iterator ci = cache.find (lpdu->destination_address);
-              CacheMap::value_type *c;
-              if (ci == cache.end())
-                {
-                  while (cache_seq.size() >= maxsize)
-                    {
-                      SeqMap::iterator si = cache_seq.begin();
-                      cache.erase(si->second);
-                      cache_seq.erase(si);
-                    }
-                  c = &(*cache.emplace(lpdu->destination_address, GroupCacheEntry(lpdu->destination_address)).first);
-                }
-              else
-                {
-                  c = &(*ci);
-                  cache_seq.erase(c->second.seq);
-                }
-              c->second.src = lpdu->source_address;
-              c->second.data = tpdu1->tsdu;
-              c->second.recvtime = time (0);
-              c->second.seq = seq++;
-              cache_seq.emplace(c->second.seq,c->first);
-              updated(c->second);
+              eibaddr_t ga = lpdu->destination_address;
+              store (ga, lpdu->source_address, tpdu1->tsdu.data(), tpdu1->tsdu.size(),
+                     time (0), seq++);
+              GroupCacheEntry c = entry (ga);
+              updated(c);
             }
         }
     }
@@ -122,7 +481,11 @@ void
 GroupCache::Clear ()
 {
   TRACEPRINTF (t, 4, "GroupCacheClear");
-  cache.clear();
+  for (uint32_t i = lru_head; i != GC_NONE; i = slots[i].next)
+    slots[i].used = false;
+  long_data.clear();
+  lru_head = lru_tail = GC_NONE;
+  used = 0;
 }
 
 void
@@ -136,17 +499,113 @@ GroupCache::Stop ()
 void
 GroupCache::remove (eibaddr_t ga)
 {
-  CacheMap::iterator f = cache.find(ga);
-  if (f != cache.end())
+  GroupCacheSlot& c = slots[ga];
+  if (!c.used)
+    return;
+  unlink (ga);
+  if (c.len > GC_INLINE)
+    long_data.erase(ga);
+  c.used = false;
+  used--;
+}
+
+void
+GroupCache::unlink (eibaddr_t ga)
+{
+  GroupCacheSlot& c = slots[ga];
+  if (c.prev == GC_NONE)
+    lru_head = c.next;
+  else
+    slots[c.prev].next = c.next;
+  if (c.next == GC_NONE)
+    lru_tail = c.prev;
+  else
+    slots[c.next].prev = c.prev;
+}
+
+void
+GroupCache::store (eibaddr_t ga, eibaddr_t src, const uint8_t *data, size_t len,
+                   time_t recvtime, uint32_t seq)
+{
+  GroupCacheSlot& c = slots[ga];
+  if (c.used)
+    {
+      unlink (ga);
+      if (c.len > GC_INLINE && len <= GC_INLINE)
+        long_data.erase(ga);
+    }
+  else
     {
-      cache_seq.erase(f->second.seq);
-      cache.erase(f);
+      while (used >= maxsize && lru_head != GC_NONE)
+        remove (lru_head);
+      c.used = true;
+      used++;
     }
+
+  c.src = src;
+  c.recvtime = recvtime;
+  c.seq = seq;
+  c.len = len;
+  if (len <= GC_INLINE)
+    memcpy (c.data, data, len);
+  else
+    long_data[ga].set (data, len);
+
+  // append to the recency list
+  c.next = GC_NONE;
+  c.prev = lru_tail;
+  if (lru_tail == GC_NONE)
+    lru_head = ga;
+  else
+    slots[lru_tail].next = ga;
+  lru_tail = ga;
+}
+
+const uint8_t *
+GroupCache::slotData (eibaddr_t ga) const
+{
+  const GroupCacheSlot& c = slots[ga];
+  if (c.len <= GC_INLINE)
+    return c.data;
+  return long_data.find(ga)->second.data();
+}
+
+GroupCacheEntry
+GroupCache::entry (eibaddr_t ga) const
+{
+  const GroupCacheSlot& c = slots[ga];
+  GroupCacheEntry e(ga);
+  e.src = c.src;
+  e.data.set (slotData (ga), c.len);
+  e.recvtime = c.recvtime;
+  e.seq = c.seq;
+  return e;
+}
+
+void
+GroupCache::updatedSince (uint32_t start, std::vector<eibaddr_t>& a) const
+{
+  for (uint32_t i = lru_tail; i != GC_NONE; i = slots[i].prev)
+    {
+      if (slots[i].seq < start)
+        break;
+      a.push_back (i);
+      if (slots[i].seq == start)
+        break;
+    }
+}
+
+GroupCacheReader::GroupCacheReader(GroupCache *gc, eibaddr_t ga)
+{
+  this->gc = gc;
+  this->ga = ga;
+  gc->add(this);
 }
 
 GroupCacheReader::GroupCacheReader(GroupCache *gc)
 {
   this->gc = gc;
+  this->ga = GC_NONE;
   gc->add(this);
 }
 
@@ -164,39 +623,61 @@ GroupCacheReader::stop(bool err)
 }
 
 void
-GroupCache::add (GroupCacheReader * entry)
+GroupCache::add (GroupCacheReader * r)
 {
-  reader.push_back(entry);
+  GroupCacheReader *&head = (r->ga == GC_NONE) ? trackers : waiters[r->ga];
+  r->prev = nullptr;
+  r->next = head;
+  if (head)
+    head->prev = r;
+  head = r;
 }
 
 void
 GroupCache::updated(GroupCacheEntry &c)
 {
-  // do this in reverse so that the update handler can safely remove itself
-  R_ITER(i,reader)
-  (*i)->updated(c);
+  auto w = waiters.find(c.dst);
+  if (w != waiters.end())
+    wake (w->second, c);
+  wake (trackers, c);
+}
+
+void
+GroupCache::wake (GroupCacheReader *r, GroupCacheEntry &c)
+{
+  // the update handler may remove itself
+  while (r)
+    {
+      GroupCacheReader *next = r->next;
+      r->updated(c);
+      r = next;
+    }
 }
 
 void
-GroupCache::remove (GroupCacheReader *)
+GroupCache::remove (GroupCacheReader *r)
 {
+  if (r->prev)
+    r->prev->next = r->next;
+  else if (r->ga == GC_NONE)
+    trackers = r->next;
+  else if (r->next)
+    waiters[r->ga] = r->next;
+  else
+    waiters.erase(r->ga);
+  if (r->next)
+    r->next->prev = r->prev;
+
+  stopped_readers.push_back(r);
   remtrigger.send();
 }
 
 void
 GroupCache::remtrigger_cb(ev::async &, int)
 {
-  // erase() doesn't do reverse iterators
-  //R_ITER(i,reader)
-  unsigned int i = reader.size();
-  while(i--)
-    {
-      GroupCacheReader *r = reader[i];
-      if (!r->stopped)
-        continue;
-      delete r;
-      reader.erase(reader.begin()+i);
-    }
+  ITER(i,stopped_readers)
+  delete *i;
+  stopped_readers.clear();
 }
 
 class GCReader : protected GroupCacheReader
@@ -208,7 +689,7 @@ class GCReader : protected GroupCacheReader
   ev::timer timeout;
 public:
   GCReader(GroupCache *gc, eibaddr_t addr, int Timeout, uint16_t age,
-           GCReadCallback cb, ClientConnPtr cc) : GroupCacheReader(gc)
+           GCReadCallback cb, ClientConnPtr cc) : GroupCacheReader(gc, addr)
   {
     this->cb = cb;
     this->cc = cc;
@@ -229,8 +710,6 @@ private:
   {
     if (stopped)
       return;
-    if (c.dst != addr)
-      return;
 
     TRACEPRINTF (gc->t, 4, "GroupCache found: %s",
                  FormatEIBAddr (c.src).c_str());
@@ -250,6 +729,16 @@ private:
   }
 };
 
+bool
+GroupCache::Peek (eibaddr_t addr, uint16_t age, GroupCacheEntry& e) const
+{
+  const GroupCacheSlot& s = slots[addr];
+  if (!enable || !s.used || (age && s.recvtime + age < time (0)))
+    return false;
+  e = entry (addr);
+  return true;
+}
+
 void
 GroupCache::Read (eibaddr_t addr, unsigned Timeout, uint16_t age,
                   GCReadCallback cb, ClientConnPtr cc)
@@ -265,14 +754,13 @@ GroupCache::Read (eibaddr_t addr, unsigned Timeout, uint16_t age,
       return;
     }
 
-  CacheMap::iterator c = cache.find (addr);
-  if (c != cache.end() && age && c->second.recvtime + age < time (0))
-    c = cache.end();
-  if (c != cache.end())
+  const GroupCacheSlot& s = slots[addr];
+  if (s.used && !(age && s.recvtime + age < time (0)))
     {
       TRACEPRINTF (t, 4, "GroupCache found: %s",
-                   FormatEIBAddr (c->second.src).c_str());
-      cb(c->second, Timeout == 0, cc);
+                   FormatEIBAddr (s.src).c_str());
+      GroupCacheEntry c = entry (addr);
+      cb(c, Timeout == 0, cc);
       return;
     }
 
@@ -284,20 +772,50 @@ GroupCache::Read (eibaddr_t addr, unsigned Timeout, uint16_t age,
       return;
     }
 
-  // No data fond. Send a Read request.
+  // No data fond. Send a Read request, unless one is already underway.
+  bool pending = (waiters.find(addr) != waiters.end());
+  new GCReader(this,addr,Timeout,age, cb,cc);
+  if (pending)
+    {
+      TRACEPRINTF (t, 4, "GroupCache read pending");
+      reads_joined++;
+      return;
+    }
+  // If read_interval suppresses the read, the reader still waits:
+  // the value may arrive anyway, e.g. from another device's write.
+  sendRead (addr);
+}
+
+bool
+GroupCache::sendRead (eibaddr_t addr)
+{
+  if (read_interval > 0)
+    {
+      timestamp_t now = getMonotonicTime();
+      auto r = last_read.find(addr);
+      if (r != last_read.end() && now - r->second < read_interval)
+        {
+          TRACEPRINTF (t, 4, "GroupCache read of %s suppressed",
+                       FormatGroupAddr (addr).c_str());
+          reads_suppressed++;
+          return false;
+        }
+      last_read[addr] = now;
+    }
+
   A_GroupValue_Read_PDU apdu;
   T_Data_Group_PDU tpdu;
   LDataPtr lpdu;
 
-  new GCReader(this,addr,Timeout,age, cb,cc);
-
+  reads_sent++;
   tpdu.tsdu = apdu.ToPacket ();
-  lpdu = LDataPtr(new L_Data_PDU ());
+  lpdu = L_Data_New ();
   lpdu->lsdu = tpdu.ToPacket ();
   lpdu->source_address = 0;
   lpdu->destination_address = addr;
   lpdu->address_type = GroupAddress;
   recv_L_Data (std::move(lpdu));
+  return true;
 }
 
 class GCTracker : protected GroupCacheReader
@@ -308,8 +826,6 @@ class GCTracker : protected GroupCacheReader
   std::vector < eibaddr_t > a;
   uint32_t start;
 public:
-  bool stopped = false;
-
   GCTracker(GroupCache *gc, uint32_t start, int Timeout,
             GCLastCallback cb, ClientConnPtr cc) : GroupCacheReader(gc)
   {
@@ -354,14 +870,7 @@ private:
   bool handler()
   {
     TRACEPRINTF (gc->t, 8, "LastUpdates start: x%x pos: x%x", start, gc->seq);
-    SeqMap::const_iterator sa = gc->cache_seq.begin();
-    SeqMap::const_iterator sb = gc->cache_seq.end();
-    while (sb != sa && (--sb)->first >= start)
-      {
-        a.push_back (sb->second);
-        if (sb->first == start)
-          break;
-      }
+    gc->updatedSince (start, a);
     cb(a,gc->seq,cc);
     stop(false);
     return true;
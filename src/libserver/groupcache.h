@@ -28,7 +28,6 @@
 #define GROUPCACHE_H
 
 #include <ctime>
-#include <map>
 #include <unordered_map>
 
 #include "client.h"
@@ -36,6 +35,11 @@
 
 class GroupCache;
 
+/** bytes of TSDU stored in the slot itself; covers standard frames */
+#define GC_INLINE 16
+/** not a group address: end of the recency list, or all of them */
+#define GC_NONE 0x10000
+
 struct GroupCacheEntry
 {
   GroupCacheEntry(eibaddr_t dst)
@@ -60,6 +64,9 @@ typedef void (*GCLastCallback)(const std::vector<eibaddr_t> &foo, uint32_t end,
 class GroupCacheReader
 {
 public:
+  /** a reader for updates of this group address */
+  GroupCacheReader(GroupCache *, eibaddr_t ga);
+  /** a reader for all updates */
   GroupCacheReader(GroupCache *);
   virtual ~GroupCacheReader();
 
@@ -67,13 +74,33 @@ public:
   GroupCache *gc;
   virtual void updated(GroupCacheEntry &) = 0;
   virtual void stop(bool err);
-};
 
-/** map last-updated sequence numbers to group addresses */
-using SeqMap = std::map<uint32_t, eibaddr_t>;
+private:
+  friend class GroupCache;
+  /** the address this reader waits for; GC_NONE: all of them */
+  uint32_t ga;
+  /** the GroupCache's list this reader is on */
+  GroupCacheReader *prev = nullptr;
+  GroupCacheReader *next = nullptr;
+};
 
-/** map group addresses to cache entries */
-using CacheMap = std::unordered_map<eibaddr_t, GroupCacheEntry>;
+/** The cache's storage, one per group address. */
+struct GroupCacheSlot
+{
+  /** receive time */
+  time_t recvtime;
+  /** seqnum */
+  uint32_t seq;
+  /** recency list, by group address; GC_NONE terminates */
+  uint32_t prev, next;
+  /** source address */
+  eibaddr_t src;
+  /** length of the layer 4 data */
+  uint8_t len;
+  bool used;
+  /** layer 4 data, if it fits */
+  uint8_t data[GC_INLINE];
+};
 
 class GroupCache:public Driver
 {
@@ -114,8 +141,10 @@ public: // but only for GroupCacheReader
 
   /** seqnum of last entry */
   uint32_t seq = 0;
-  /** map seqnum to group address */
-  SeqMap cache_seq;
+  /** how long a client's read waits for the bus to answer, ms */
+  unsigned read_timeout = 75;
+  /** collect the group addresses updated since seqnum @start, newest first */
+  void updatedSince (uint32_t start, std::vector<eibaddr_t>& a) const;
 
   /** Turn on caching, calls l3.registerGroupCallBack(ANY) */
   bool Start ();
@@ -123,7 +152,14 @@ public: // but only for GroupCacheReader
   void Clear ();
   /** Turn off caching, deregisters */
   void Stop ();
+  bool isEnabled () const
+  {
+    return enable;
+  }
 
+  /** get the cache entry for this address, if there is one
+   * which is not older than @age seconds (0: any) */
+  bool Peek (eibaddr_t addr, uint16_t age, GroupCacheEntry& e) const;
   /** read, and optionally wait for, a cache entry for this address */
   void Read (eibaddr_t addr, unsigned timeout, uint16_t age,
              GCReadCallback cb, ClientConnPtr c);
@@ -134,9 +170,83 @@ public: // but only for GroupCacheReader
                      GCLastCallback cb, ClientConnPtr c);
 
 private:
-  std::vector < GroupCacheReader * > reader;
-  /** The Cache */
-  CacheMap cache;
+  /** readers waiting for a group address, by address;
+   * the rest of the list is chained via GroupCacheReader::next */
+  std::unordered_map<eibaddr_t, GroupCacheReader *> waiters;
+  /** readers which want to see every update */
+  GroupCacheReader *trackers = nullptr;
+  /** readers which have been stopped, to be deleted */
+  std::vector<GroupCacheReader *> stopped_readers;
+  void wake (GroupCacheReader *r, GroupCacheEntry &c);
+
+  /** ask the bus for this group address's value
+   * @return false if read_interval suppressed the read */
+  bool sendRead (eibaddr_t addr);
+  /** minimum time between two reads of a group address, µs */
+  timestamp_t read_interval;
+  /** when each group address has last been read, if read_interval is set */
+  std::unordered_map<eibaddr_t, timestamp_t> last_read;
+  unsigned long reads_sent = 0;
+  /** cache misses which didn't need a read because one was pending */
+  unsigned long reads_joined = 0;
+  /** reads which were dropped because of read_interval */
+  unsigned long reads_suppressed = 0;
+
+  /** Read these group addresses in the background, ascending.
+   * See doc/inifile.rst. */
+  std::vector<eibaddr_t> warmup;
+  bool readWarmup (const std::string& list, const std::string& where);
+  bool readWarmupFile (const std::string& file);
+  /** re-read values older than this, seconds; 0: only missing ones */
+  int warmup_max_age;
+  /** seconds between passes; 0: only after starting */
+  float warmup_interval;
+  /** seconds between two reads, at least */
+  float warmup_delay;
+  /** back off while the links to the bus are busier than this */
+  unsigned int warmup_max_queue;
+  float warmup_max_load;
+  ev::timer warmup_timer;
+  void warmup_timer_cb(ev::timer &w, int revents);
+  /** position in the current pass */
+  size_t warmup_pos = 0;
+  /** the current delay, backed off from warmup_delay */
+  float warmup_wait;
+  /** the bus links' frame counter, and when it's been sampled */
+  unsigned long warmup_frames = 0;
+  timestamp_t warmup_sampled = 0;
+  unsigned long warmup_reads = 0;
+  unsigned long warmup_backoffs = 0;
+
+  /** Persist the cache contents across restarts. See doc/inifile.rst. */
+  std::string snapshot;
+  /** discard loaded entries older than this, seconds; 0: keep all */
+  int snapshot_max_age;
+  /** seconds; 0: only when stopping */
+  float snapshot_interval;
+  ev::timer snapshot_timer;
+  void snapshot_timer_cb(ev::timer &w, int revents);
+  bool snapshot_loaded = false;
+  /** seq when the snapshot was last written */
+  uint32_t snapshot_seq = 0;
+  void loadSnapshot();
+  void saveSnapshot();
+
+  /** The Cache, indexed by group address */
+  std::vector<GroupCacheSlot> slots;
+  /** data of extended frames, which don't fit into their slot */
+  std::unordered_map<eibaddr_t, CArray> long_data;
+  /** the recency list: least and most recently updated entry */
+  uint32_t lru_head = GC_NONE;
+  uint32_t lru_tail = GC_NONE;
+  /** number of entries */
+  unsigned int used = 0;
+  void unlink (eibaddr_t ga);
+  /** store a value, evicting the oldest entries if the cache is full */
+  void store (eibaddr_t ga, eibaddr_t src, const uint8_t *data, size_t len,
+              time_t recvtime, uint32_t seq);
+  const uint8_t *slotData (eibaddr_t ga) const;
+  GroupCacheEntry entry (eibaddr_t ga) const;
   /** controlled by .Start/Stop; if false, the whole code does nothing */
   bool enable = false;
   /** max size of cache */
@@ -91,6 +91,81 @@ LastUpdates2Callback(const std::vector<eibaddr_t> &addrs, uint32_t end, ClientCo
   c->sendmessage (erg.size(), erg.data());
 }
 
+/** Request: start, age, max. length, then any number of group address
+ * ranges (first, last). No ranges means all of them.
+ * Reply: the address to continue from (0: done), then the entries:
+ * src, dst, age (2 bytes each), data length (1 byte), data.
+ * Entries before @start are skipped, so ranges must be in ascending order
+ * if the reply doesn't fit.
+ * If the cache is disabled, the reply has no address and no entries.
+ */
+static void
+ReadBulk (GroupCachePtr cache, ClientConnPtr c, uint8_t *buf, size_t len)
+{
+  if (len < 8 || (len - 8) % 4)
+    {
+      c->sendreject ();
+      return;
+    }
+  if (!cache->isEnabled ())
+    {
+      c->sendreject (EIB_CACHE_READ_BULK);
+      return;
+    }
+  eibaddr_t start = (buf[2] << 8) | buf[3];
+  uint16_t age = (buf[4] << 8) | buf[5];
+  size_t max = (buf[6] << 8) | buf[7];
+  // the length field has 16 bits
+  if (max > 0xffff - 4)
+    max = 0xffff - 4;
+
+  static const uint8_t all[] = { 0x00, 0x00, 0xff, 0xff };
+  const uint8_t *ranges = (len > 8) ? buf + 8 : all;
+  size_t n_ranges = (len > 8) ? (len - 8) / 4 : 1;
+
+  CArray erg (4);
+  EIBSETTYPE (erg, EIB_CACHE_READ_BULK);
+  time_t now = time (0);
+  uint32_t next = 0;
+  GroupCacheEntry e (0);
+  for (size_t i = 0; i < n_ranges && !next; i++)
+    {
+      uint32_t ga = (ranges[i * 4] << 8) | ranges[i * 4 + 1];
+      uint32_t last = (ranges[i * 4 + 2] << 8) | ranges[i * 4 + 3];
+      if (ga < start)
+        ga = start;
+      for (; ga <= last; ga++)
+        {
+          if (!cache->Peek (ga, age, e))
+            continue;
+          if (erg.size() - 4 + 7 + e.data.size() > max)
+            {
+              next = ga;
+              break;
+            }
+          time_t a = now - e.recvtime;
+          if (a > 0xffff)
+            a = 0xffff;
+          const uint8_t h[] =
+            {
+              uint8_t(e.src >> 8), uint8_t(e.src), uint8_t(e.dst >> 8), uint8_t(e.dst),
+              uint8_t(a >> 8), uint8_t(a), uint8_t(e.data.size())
+            };
+          erg.insert (erg.end(), h, h + sizeof(h));
+          erg.insert (erg.end(), e.data.begin(), e.data.end());
+        }
+    }
+  if (next && erg.size() == 4)
+    {
+      // not even one entry fits
+      c->sendreject ();
+      return;
+    }
+  erg[2] = (next >> 8) & 0xff;
+  erg[3] = next & 0xff;
+  c->sendmessage (erg.size(), erg.data());
+}
+
 void
 GroupCacheRequest (ClientConnPtr c, uint8_t *buf, size_t len)
 {
@@ -148,7 +223,8 @@ GroupCacheRequest (ClientConnPtr c, uint8_t *buf, size_t len)
             }
           age = (buf[4] << 8) | (buf[5]);
         }
-      cache->Read (dst, EIBTYPE (buf) == EIB_CACHE_READ_NOWAIT ? 0 : 75,
+      cache->Read (dst,
+                   EIBTYPE (buf) == EIB_CACHE_READ_NOWAIT ? 0 : cache->read_timeout,
                    age, ReadCallback, c);
       break;
 
@@ -178,6 +254,10 @@ GroupCacheRequest (ClientConnPtr c, uint8_t *buf, size_t len)
       break;
     }
 
+    case EIB_CACHE_READ_BULK:
+      ReadBulk (cache, c, buf, len);
+      break;
+
     default:
       c->sendreject ();
     }
@@ -0,0 +1,107 @@
+/*
+    EIBD eib bus access and management daemon
+    Copyright (C) 2005-2011 Martin Koegler <mkoegler@auto.tuwien.ac.at>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <cstdio>
+#include <string>
+
+#include "common.h"
+
+/** A log-linear histogram of durations in µs.
+ *
+ * Values below 4 get a bucket each; above that, every power of two is
+ * split into 4 equally wide buckets. The error of a reported value is
+ * thus at most 25%, with 156 buckets covering 12 days.
+ */
+class LatencyHistogram
+{
+  static const int sub_bits = 2;
+  static const int sub = 1 << sub_bits;
+  static const int max_bits = 40;
+  static const int nbuckets = (max_bits - sub_bits + 1) * sub;
+
+  unsigned int bucket[nbuckets] = {};
+
+  static int index (timestamp_t v)
+  {
+    if (v < sub)
+      return v < 0 ? 0 : v;
+    int e = 63 - __builtin_clzll (v);
+    if (e >= max_bits)
+      return nbuckets - 1;
+    return (e - sub_bits + 1) * sub + ((v >> (e - sub_bits)) & (sub - 1));
+  }
+  /** the smallest value which goes to bucket @i */
+  static timestamp_t lower (int i)
+  {
+    if (i < sub)
+      return i;
+    int g = i / sub;
+    return timestamp_t(sub + i % sub) << (g - 1);
+  }
+
+public:
+  unsigned long count = 0;
+  timestamp_t sum = 0;
+  timestamp_t max = 0;
+
+  void add (timestamp_t v)
+  {
+    bucket[index (v)]++;
+    count++;
+    sum += v;
+    if (max < v)
+      max = v;
+  }
+
+  /** Upper bound of the bucket which contains the @p'th percentile */
+  timestamp_t percentile (double p) const
+  {
+    if (!count)
+      return 0;
+    unsigned long want = (unsigned long)(count * p / 100);
+    if (want >= count)
+      want = count - 1;
+    unsigned long seen = 0;
+    for (int i = 0; i < nbuckets; i++)
+      {
+        seen += bucket[i];
+        if (seen > want)
+          {
+            timestamp_t hi = i + 1 < nbuckets ? lower (i + 1) - 1 : max;
+            return hi < max ? hi : max;
+          }
+      }
+    return max;
+  }
+
+  /** "n=… avg=… p50=… p90=… p99=… max=…" */
+  std::string text () const
+  {
+    char buf[160];
+    snprintf (buf, sizeof(buf), "n=%lu avg=%lld p50=%lld p90=%lld p99=%lld max=%lld",
+              count, count ? sum / (timestamp_t)count : 0LL,
+              percentile (50), percentile (90), percentile (99), max);
+    return buf;
+  }
+};
+
+#endif
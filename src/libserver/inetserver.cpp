@@ -77,7 +77,7 @@ InetServer::start()
       goto ex2;
     }
 
-  if (listen (fd, 10) == -1)
+  if (listen (fd, SOMAXCONN) == -1)
     {
       ERRORPRINTF (t, E_ERROR | 14, "OpenInetSocket %d: listen: %s", port, strerror(errno));
       goto ex2;
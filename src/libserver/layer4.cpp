@@ -32,6 +32,19 @@ T_Group::T_Group (T_Reader<GroupComm> *app, LinkConnectClientPtr lc, eibaddr_t g
   groupaddr = group;
 }
 
+bool
+T_Group::setup ()
+{
+  if (!Layer4commonWO::setup())
+    return false;
+  auto c = std::dynamic_pointer_cast<LinkConnect>(conn.lock());
+  if (c == nullptr)
+    return false;
+  c->subscribeGroups(false);
+  c->subscribeGroup(groupaddr);
+  return true;
+}
+
 void
 T_Group::send_L_Data (LDataPtr lpdu)
 {
@@ -54,7 +67,7 @@ T_Group::recv_Data (const CArray & c)
   tpdu.tsdu = c;
   std::string s = tpdu.Decode (t);
   TRACEPRINTF (t, 4, "Recv Group %s", s);
-  LDataPtr lpdu = LDataPtr(new L_Data_PDU ());
+  LDataPtr lpdu = L_Data_New ();
   lpdu->source_address = 0;
   lpdu->destination_address = groupaddr;
   lpdu->address_type = GroupAddress;
@@ -83,6 +96,23 @@ T_Broadcast::~T_Broadcast ()
   TRACEPRINTF (t, 4, "CloseBroadcast");
 }
 
+bool
+T_Broadcast::setup ()
+{
+  if (!Layer4commonWO::setup())
+    return false;
+  if (!write_only)
+    {
+      // we only want broadcasts
+      auto c = std::dynamic_pointer_cast<LinkConnect>(conn.lock());
+      if (c == nullptr)
+        return false;
+      c->subscribeGroups(false);
+      c->subscribeGroup(0);
+    }
+  return true;
+}
+
 void
 T_Broadcast::send_L_Data (LDataPtr lpdu)
 {
@@ -105,7 +135,7 @@ T_Broadcast::recv_Data (const CArray & c)
   tpdu.tsdu = c;
   std::string s = tpdu.Decode (t);
   TRACEPRINTF (t, 4, "Recv Broadcast %s", s);
-  LDataPtr lpdu = LDataPtr(new L_Data_PDU ());
+  LDataPtr lpdu = L_Data_New ();
   lpdu->source_address = 0;
   lpdu->destination_address = 0;
   lpdu->address_type = GroupAddress;
@@ -139,7 +169,7 @@ void
 T_TPDU::recv_Data (const TpduComm & c)
 {
   t->TracePacket (4, "Recv TPDU", c.data);
-  LDataPtr lpdu = LDataPtr(new L_Data_PDU ());
+  LDataPtr lpdu = L_Data_New ();
   lpdu->source_address = src;
   lpdu->destination_address = c.addr;
   lpdu->address_type = IndividualAddress;
@@ -199,7 +229,7 @@ T_Individual::recv_Data (const CArray & c)
   tpdu.tsdu = c;
   std::string s = tpdu.Decode (t);
   TRACEPRINTF (t, 4, "Recv Individual %s", s);
-  LDataPtr lpdu = LDataPtr(new L_Data_PDU ());
+  LDataPtr lpdu = L_Data_New ();
   lpdu->source_address = 0;
   lpdu->destination_address = dest;
   lpdu->address_type = IndividualAddress;
@@ -324,7 +354,7 @@ T_Connection::SendConnect ()
 {
   TRACEPRINTF (t, 4, "SendConnect");
   T_Connect_PDU tpdu;
-  LDataPtr lpdu = LDataPtr(new L_Data_PDU ());
+  LDataPtr lpdu = L_Data_New ();
   lpdu->source_address = 0;
   lpdu->destination_address = dest;
   lpdu->address_type = IndividualAddress;
@@ -345,7 +375,7 @@ T_Connection::SendDisconnect ()
 {
   TRACEPRINTF (t, 4, "SendDisconnect");
   T_Disconnect_PDU tpdu;
-  LDataPtr lpdu = LDataPtr(new L_Data_PDU ());
+  LDataPtr lpdu = L_Data_New ();
   lpdu->source_address = 0;
   lpdu->destination_address = dest;
   lpdu->address_type = IndividualAddress;
@@ -362,7 +392,7 @@ T_Connection::SendAck (int sequence_number)
   TRACEPRINTF (t, 4, "SendACK %d", sequence_number);
   T_ACK_PDU tpdu;
   tpdu.sequence_number = sequence_number;
-  LDataPtr lpdu = LDataPtr(new L_Data_PDU ());
+  LDataPtr lpdu = L_Data_New ();
   lpdu->source_address = 0;
   lpdu->destination_address = dest;
   lpdu->address_type = IndividualAddress;
@@ -379,7 +409,7 @@ T_Connection::SendData (int sequence_number, const CArray & c)
   tpdu.tsdu = c;
   tpdu.sequence_number = sequence_number;
   TRACEPRINTF (t, 4, "SendData %s", tpdu.Decode (t));
-  LDataPtr lpdu = LDataPtr(new L_Data_PDU ());
+  LDataPtr lpdu = L_Data_New ();
   lpdu->source_address = 0;
   lpdu->destination_address = dest;
   lpdu->address_type = IndividualAddress;
@@ -456,7 +486,7 @@ GroupSocket::recv_Data (const GroupAPDU & c)
   tpdu.tsdu = c.data;
   std::string s = tpdu.Decode (t);
   TRACEPRINTF (t, 4, "Recv GroupSocket %s %s", FormatGroupAddr(c.dst), s);
-  LDataPtr lpdu = LDataPtr(new L_Data_PDU ());
+  LDataPtr lpdu = L_Data_New ();
   lpdu->source_address = 0;
   lpdu->destination_address = c.dst;
   lpdu->address_type = GroupAddress;
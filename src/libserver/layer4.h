@@ -63,7 +63,21 @@ public:
     return !write_only;
   }
 
-private:
+  virtual bool setup()
+  {
+    if (!Layer4common<COMM>::setup())
+      return false;
+    if (write_only)
+      {
+        auto c = std::dynamic_pointer_cast<LinkConnect>(this->conn.lock());
+        if (c == nullptr)
+          return false;
+        c->subscribeGroups(false);
+      }
+    return true;
+  }
+
+protected:
   bool write_only;
 };
 
@@ -121,6 +135,8 @@ public:
     return (addr == groupaddr);
   }
 
+  virtual bool setup();
+
 private:
   /** group address */
   eibaddr_t groupaddr;
@@ -150,6 +166,8 @@ public:
   void send_L_Data (LDataPtr l);
   /** send APDU c */
   void recv_Data (const CArray & c);
+
+  virtual bool setup();
 };
 
 using T_BroadcastPtr = std::shared_ptr<T_Broadcast>;
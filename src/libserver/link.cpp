@@ -69,6 +69,7 @@ LinkBase::LinkBase(BaseRouter&, IniSectionPtr& s, TracePtr tr) : cfg(s)
 {
   t = TracePtr(new Trace(*tr, s));
   t->setAuxName("Base");
+  evloop = loop;
 }
 
 std::string
@@ -84,6 +85,7 @@ LinkConnect_::LinkConnect_(BaseRouter& r, IniSectionPtr& c, TracePtr tr)
   : router(r), LinkRecv(r,c,tr)
 {
   t->setAuxName("Conn_");
+  stack_loop = loop;
   //Router& rt = dynamic_cast<Router&>(r);
 }
 
@@ -126,6 +128,9 @@ LinkConnect::setState(LConnState new_state)
   LConnState old_state = state;
   const char *osn = stateName();
   state = new_state;
+  stats.state_changes++;
+  if (new_state == L_error)
+    stats.errors++;
   TRACEPRINTF(t, 5, "%s => %s", osn, stateName());
 
   switch(old_state)
@@ -227,11 +232,48 @@ inval:
   return;
 }
 
+void
+LinkConnect::subscribeGroups(bool all)
+{
+  if (groups_all == all)
+    return;
+  Router& r = static_cast<Router&>(router);
+  r.indexGroups(*this, false);
+  groups_all = all;
+  r.indexGroups(*this, true);
+}
+
+void
+LinkConnect::subscribeGroup(eibaddr_t first, eibaddr_t last, bool on)
+{
+  Router& r = static_cast<Router&>(router);
+  for (unsigned int ga = first; ga <= last; ga++)
+    {
+      if (on ? !groups.insert(ga).second : !groups.erase(ga))
+        continue;
+      if (!groups_all)
+        r.indexGroup(*this, ga, on);
+    }
+}
+
 void
 LinkConnect::setAddress(eibaddr_t addr)
 {
+  Router& r = static_cast<Router&>(router);
+  eibaddr_t old = this->addr;
   this->addr = addr;
   this->addr_local = false;
+  if (old == addr)
+    return;
+  // A threaded stack calls this on its own thread. Its ThreadFilter
+  // tells the router.
+  if (stack_loop != loop)
+    return;
+  // no-ops if we're not registered yet
+  if (old)
+    r.dropAddress(old, *this);
+  if (addr)
+    r.addAddress(addr, *this);
 }
 bool
 LinkConnectSingle::setup()
@@ -250,6 +292,9 @@ LinkConnect::start()
 {
   TRACEPRINTF(t, 5, "Starting");
   send_more = true;
+  sent_at = 0;
+  sent_ingress = 0;
+  send_q.clear();
   LinkConnect_::start();
 }
 
@@ -330,6 +375,8 @@ LinkConnect::setup()
   x_may_fail = cfg->value("may-fail",false);
   x_max_retries = cfg->value("max-retries",-1);
   x_retry_delay = cfg->value("retry-delay",1.);
+  max_queue = cfg->value("max-queue",(int)max_queue);
+  send_q.weight = cfg->value("prio-weight",(int)send_q.weight);
   return true;
 }
 
@@ -415,27 +462,89 @@ LinkConnect::send_Next()
 {
   send_more = true;
   TRACEPRINTF(t, 6, "sendNext called, send_more set");
-  static_cast<Router&>(router).send_Next();
+  if (sent_at)
+    {
+      timestamp_t now = getMonotonicTime();
+      timestamp_t d = now - sent_at;
+      sent_at = 0;
+      stats.next_wait += d;
+      stats.next_count++;
+      if (stats.next_wait_max < d)
+        stats.next_wait_max = d;
+      if (sent_ingress)
+        {
+          latency[sent_ingress_link].done.add (now - sent_ingress);
+          sent_ingress = 0;
+        }
+    }
+  if (!sending)
+    send_queued();
 }
 
 void
 LinkConnect::send_L_Data (LDataPtr l)
 {
-  send_more = false;
   assert (state == L_up);
-  TRACEPRINTF(t, 6, "sending, send_more clear");
-  LinkConnect_::send_L_Data(std::move(l));
+  if (send_q.size() >= max_queue)
+    {
+      if (!queue_overflow)
+        ERRORPRINTF (t, E_WARNING | 147, "send queue full (%d), dropping packets", send_q.size());
+      queue_overflow = true;
+      queue_drops++;
+      TRACEPRINTF(t, 6, "Drop: %s", l->Decode (t));
+      return;
+    }
+  send_q.put(std::move(l));
+  if (send_q.size() > queue_high)
+    {
+      queue_high = send_q.size();
+      if (queue_high > 1)
+        TRACEPRINTF(t, 6, "send queue: new max %d", queue_high);
+    }
+  if (!sending)
+    send_queued();
+}
+
+void
+LinkConnect::send_queued ()
+{
+  sending = true;
+  while (send_more && !send_q.empty() && state == L_up)
+    {
+      send_more = false;
+      TRACEPRINTF(t, 6, "sending, send_more clear");
+      LDataPtr l = send_q.get();
+      stats.tx_frames++;
+      stats.tx_bytes += l->lsdu.size();
+      sent_at = getMonotonicTime();
+      if (l->ingress && static_cast<Router&>(router).latency_stats)
+        {
+          latency[l->ingress_link].send.add (sent_at - l->ingress);
+          sent_ingress = l->ingress;
+          sent_ingress_link = l->ingress_link;
+        }
+      LinkConnect_::send_L_Data(std::move(l));
+    }
+  if (send_q.empty())
+    queue_overflow = false;
+  sending = false;
 }
 
 void
 LinkConnect::stopped(bool err)
 {
+  send_q.clear();
+  if (queue_drops)
+    ERRORPRINTF (t, E_INFO | 148, "send queue: max %d, %lu dropped", queue_high, queue_drops);
+  send_q.traceStats (t, "send queue");
   setState(err ? L_error : L_down);
 }
 
 void
 LinkConnect::recv_L_Data (LDataPtr l)
 {
+  stats.rx_frames++;
+  stats.rx_bytes += l->lsdu.size();
   static_cast<Router&>(router).recv_L_Data(std::move(l), *this);
 }
 
@@ -463,10 +572,17 @@ LinkConnect_::checkSysGroupAddress(eibaddr_t addr)
   return static_cast<Router&>(router).checkGroupAddress(addr, nullptr);
 }
 
+bool
+LinkConnect_::hasFilters() const
+{
+  return send.get() != static_cast<LinkBase *>(driver.get());
+}
+
 
 void
 LinkConnect::recv_L_Busmonitor (LBusmonPtr l)
 {
+  stats.rx_busmon++;
   static_cast<Router&>(router).recv_L_Busmonitor(std::move(l));
 }
 
@@ -666,6 +782,7 @@ Filter::Filter(const LinkConnectPtr_& c, IniSectionPtr& s)
   : LinkRecv(c->router, s, c->t)
 {
   conn = c;
+  evloop = c->stack_loop;
   t->setAuxName(c->t->name);
 }
 
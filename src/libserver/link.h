@@ -31,11 +31,14 @@
 #include <ostream>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "common.h"
+#include "histogram.h"
 #include "inifile.h"
 #include "lpdu.h"
+#include "prioqueue.h"
 
 /*
  * This code implements the basis for the interface between the KNX router
@@ -99,8 +102,10 @@
  * Sending data: LinkConnect::send_L_Data() calls the first filter, which
  *               forwards to the driver, via the .send pointer.
  *               When the packet has been transmitted successfully, 
- *               the driver MUST call "send_Next", which tells the router
- *               that the driver is ready for the next packet.
+ *               the driver MUST call "send_Next", which tells the
+ *               LinkConnect that the driver is ready for the next packet.
+ *               Packets that arrive in the meantime are queued there, so
+ *               a slow link doesn't hold up the rest of the system.
  *
  * All pointers from LinkConnect towards the driver, along the .send chain,
  * are shared pointers. All pointers towards LinkConnect, along the .recv
@@ -251,6 +256,9 @@ public:
   /** debug output */
   TracePtr t;
 
+  /** the event loop to run on; a threaded link's driver stack has its own */
+  struct ev_loop *evloop;
+
   /** This thing's name; drivers/filters override this with their "real" name */
   virtual const std::string& name()
   {
@@ -382,6 +390,9 @@ public:
 
   BaseRouter& router;
 
+  /** the event loop which the driver stack below this runs on */
+  struct ev_loop *stack_loop;
+
   virtual bool setup();
   virtual void start();
   virtual void stop(bool err);
@@ -393,6 +404,9 @@ public:
     link(std::dynamic_pointer_cast<LinkBase>(d));
   }
 
+  /** Is there a filter between this and the driver? */
+  bool hasFilters() const;
+
   /** You can't unlink the root of the chain … */
   virtual void unlink()
   {
@@ -444,6 +458,36 @@ enum LConnState
   L_going_up,
 };
 
+/** Runtime counters of a link. See Router::statsText(). */
+struct LinkStats
+{
+  /** frames and APDU octets received from the driver */
+  unsigned long rx_frames = 0;
+  unsigned long rx_bytes = 0;
+  /** frames and APDU octets handed to the driver */
+  unsigned long tx_frames = 0;
+  unsigned long tx_bytes = 0;
+  /** busmonitor frames received */
+  unsigned long rx_busmon = 0;
+  /** time from handing a frame to the driver until its send_Next, µs */
+  timestamp_t next_wait = 0;
+  timestamp_t next_wait_max = 0;
+  unsigned long next_count = 0;
+  /** state changes, and how many of them were errors */
+  unsigned long state_changes = 0;
+  unsigned long errors = 0;
+};
+
+/** Latency of the frames a link sends, from their arrival at knxd.
+ * Kept per ingress link, see L_Data_PDU::ingress_link. */
+struct LinkLatency
+{
+  /** until the frame is handed to the driver */
+  LatencyHistogram send;
+  /** until the driver calls send_Next for it */
+  LatencyHistogram done;
+};
+
 /**
  * A LinkConnect is something which the router knows about.
  * For non-servers, it holds a pointer to the driver and to the bottom of
@@ -477,18 +521,55 @@ public:
   int seq = 0;
   /** link map index for the router */
   int pos = 0;
+  /** addresses the router has associated with this link */
+  std::unordered_set<eibaddr_t> routed_addrs;
+
+  /** Group address subscription, indexed by the router.
+   * By default a link is offered every group telegram, subject to
+   * checkGroupAddress(). Links which only want a few group addresses
+   * should subscribe to them; the router then doesn't bother the link
+   * with anything else.
+   */
+  bool groups_all = true;
+  std::unordered_set<eibaddr_t> groups;
+  /** want all group addresses, or only the ones explicitly subscribed */
+  void subscribeGroups (bool all);
+  /** (un)subscribe to a single group address, or a range */
+  void subscribeGroup (eibaddr_t first, eibaddr_t last, bool on = true);
+  void subscribeGroup (eibaddr_t ga, bool on = true)
+  {
+    subscribeGroup (ga, ga, on);
+  }
   /** last state change */
   time_t changed = 0;
 
   /** This is the main flow control mechanism. Whenever "send_more" is set,
-   * the router may call "send_L_Data" ONCE. It will then wait for
+   * the driver stack may be passed ONE packet. We then wait for
    * "send_Next" to be called before sending the next message.
    * (This call may happen during the call to "send_L_Data", or some time later.)
+   * The router doesn't care: packets that arrive while the driver is busy
+   * are queued here, up to "max-queue" of them.
    */
   bool send_more = true;
   virtual void send_L_Data (LDataPtr l);
   virtual void send_Next ();
 
+  /** max length of the send queue */
+  unsigned int max_queue = 1000;
+  /** max length the send queue has reached */
+  unsigned int queue_high = 0;
+  /** number of packets dropped because the send queue was full */
+  unsigned long queue_drops = 0;
+  /** current length of the send queue */
+  size_t queue_length() const
+  {
+    return send_q.size();
+  }
+
+  LinkStats stats;
+  /** by ingress link; only filled if the router's latency-stats is set */
+  std::unordered_map<int, LinkLatency> latency;
+
   /**
    * This is responsible for setting up the filters. Don't call it twice!
    * Precondition: set_driver() has been called.
@@ -519,6 +600,20 @@ private:
   void retry_timer_cb(ev::timer &w, int revents);
 
   bool addr_local = true;
+
+  /** packets waiting for send_more */
+  LDataQueue send_q;
+  /** when the driver got the frame it hasn't acknowledged yet */
+  timestamp_t sent_at = 0;
+  /** … and when / where that frame arrived, for LinkLatency::done */
+  timestamp_t sent_ingress = 0;
+  int sent_ingress_link = -1;
+  /** flag to prevent recursion */
+  bool sending = false;
+  /** the queue has overflowed since it was last empty */
+  bool queue_overflow = false;
+  /** feed queued packets to the driver */
+  void send_queued ();
 };
 
 /** connection for a server's client */
@@ -590,6 +685,7 @@ public:
   Server(BaseRouter& r, IniSectionPtr& c) : LinkConnect(r,c,r.t)
   {
     t->setAuxName("Server");
+    groups_all = false;
   }
   virtual ~Server() = default;
 
@@ -762,6 +858,7 @@ public:
   Driver(const LinkConnectPtr_& c, IniSectionPtr& s) : LinkBase(c->router, s, c->t)
   {
     conn = c;
+    evloop = c->stack_loop;
     t->setAuxName("Driver");
   }
   virtual ~Driver() = default;
@@ -0,0 +1,446 @@
+/*
+    EIBD eib bus access and management daemon
+    Copyright (C) 2005-2011 Martin Koegler <mkoegler@auto.tuwien.ac.at>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "linkthread.h"
+
+#include <chrono>
+#include <pthread.h>
+#include <signal.h>
+
+#include "router.h"
+
+WorkerLoop::WorkerLoop (const std::string& n, TracePtr tr) : name(n), stop_req(false)
+{
+  t = TracePtr(new Trace(*tr, "thread:" + n));
+  loop = ev_loop_new (ev_backend (::loop) | EVFLAG_NOSIGMASK);
+  if (loop == nullptr)
+    return;
+
+  stop_trigger.set (loop);
+  stop_trigger.set<WorkerLoop, &WorkerLoop::stop_cb>(this);
+  stop_trigger.start ();
+}
+
+WorkerLoop::~WorkerLoop ()
+{
+  stop ();
+  if (loop == nullptr)
+    return;
+  stop_trigger.stop ();
+  ev_loop_destroy (loop);
+}
+
+bool
+WorkerLoop::start ()
+{
+  if (loop == nullptr)
+    return false;
+  if (running ())
+    return true;
+  stop_req = false;
+
+  // Signals are handled by the main loop.
+  sigset_t all, old;
+  sigfillset (&all);
+  pthread_sigmask (SIG_BLOCK, &all, &old);
+  thr = std::thread (&WorkerLoop::run, this);
+  pthread_sigmask (SIG_SETMASK, &old, nullptr);
+
+#ifdef __linux__
+  std::string tn = "knxd:" + name;
+  pthread_setname_np (thr.native_handle (), tn.substr (0, 15).c_str ());
+#endif
+  TRACEPRINTF (t, 4, "started");
+  return true;
+}
+
+void
+WorkerLoop::stop ()
+{
+  if (!running ())
+    return;
+  stop_req = true;
+  stop_trigger.send ();
+  thr.join ();
+  TRACEPRINTF (t, 4, "stopped");
+}
+
+void
+WorkerLoop::run ()
+{
+  ev_run (loop, 0);
+}
+
+void
+WorkerLoop::stop_cb (ev::async &, int)
+{
+  ev_break (loop, EVBREAK_ALL);
+}
+
+
+ThreadFilter::ThreadFilter (const LinkConnectPtr_& c, IniSectionPtr& s, WorkerLoopPtr w)
+  : Filter(c, s), worker(w), drops(0), q_pending(false)
+{
+  t->setAuxName("Thread");
+
+  down_trigger.set (worker->loop);
+  down_trigger.set<ThreadFilter, &ThreadFilter::down_cb>(this);
+  down_trigger.start ();
+
+  up_trigger.set (::loop);
+  up_trigger.set<ThreadFilter, &ThreadFilter::up_cb>(this);
+  up_trigger.start ();
+}
+
+const std::string&
+ThreadFilter::name ()
+{
+  static const std::string n = "thread";
+  return n;
+}
+
+bool
+ThreadFilter::setup ()
+{
+  if (!Filter::setup ())
+    return false;
+
+  size_t n = cfg->value("thread-queue", 256);
+  if (n < 2 * reserve)
+    n = 2 * reserve;
+  down.reset (new SpscRing<Msg>(n));
+  up.reset (new SpscRing<Msg>(n));
+
+  // The worker isn't running this stack yet, so it's safe to ask it.
+  tables = scan ();
+  learned.resize (0x10000);
+  return true;
+}
+
+std::shared_ptr<ThreadFilter::Tables>
+ThreadFilter::scan ()
+{
+  std::shared_ptr<Tables> tb (new Tables);
+  tb->has.resize (0x10000);
+  tb->addr_ok.resize (0x10000);
+  tb->group_ok.resize (0x10000);
+  for (unsigned a = 0; a < 0x10000; a++)
+    {
+      tb->has[a] = Filter::hasAddress (a);
+      tb->addr_ok[a] = Filter::checkAddress (a);
+      tb->group_ok[a] = Filter::checkGroupAddress (a);
+    }
+  return tb;
+}
+
+void
+ThreadFilter::refresh () const
+{
+  if (refresh_pending || !worker->running ())
+    return;
+  timestamp_t now = getMonotonicTime ();
+  if (now - refresh_time < 1000000)
+    return;
+  refresh_time = now;
+  refresh_pending = true;
+
+  Msg m;
+  m.kind = Msg::REFRESH;
+  if (!push (*down, down_trigger, std::move (m)))
+    refresh_pending = false;
+}
+
+void
+ThreadFilter::syncAddress ()
+{
+  auto c = std::dynamic_pointer_cast<LinkConnect>(conn.lock ());
+  if (c == nullptr || c->addr == indexed_addr)
+    return;
+  Router& r = static_cast<Router&>(c->router);
+  if (indexed_addr)
+    r.dropAddress (indexed_addr, *c);
+  indexed_addr = c->addr;
+  if (indexed_addr)
+    r.addAddress (indexed_addr, *c);
+}
+
+bool
+ThreadFilter::push (SpscRing<Msg>& r, ev::async& trigger, Msg&& m)
+{
+  if (m.kind == Msg::DATA || m.kind == Msg::BUSMON)
+    if (r.size () + reserve >= r.capacity ())
+      return false;
+  if (!r.push (std::move (m)))
+    return false;
+  trigger.send ();
+  return true;
+}
+
+void
+ThreadFilter::send_L_Data (LDataPtr l)
+{
+  Msg m;
+  m.kind = Msg::DATA;
+  m.l = std::move (l);
+  if (push (*down, down_trigger, std::move (m)))
+    return;
+
+  ERRORPRINTF (t, E_WARNING | 149, "thread %s: queue full, dropped a frame", worker->name);
+  Filter::send_Next ();
+}
+
+void
+ThreadFilter::start ()
+{
+  if (!worker->start ())
+    {
+      ERRORPRINTF (t, E_ERROR | 150, "thread %s: could not start", worker->name);
+      Filter::stopped (true);
+      return;
+    }
+  Msg m;
+  m.kind = Msg::START;
+  push (*down, down_trigger, std::move (m));
+}
+
+void
+ThreadFilter::stop (bool err)
+{
+  Msg m;
+  m.kind = Msg::STOP;
+  m.err = err;
+  if (!worker->running () || !push (*down, down_trigger, std::move (m)))
+    Filter::stopped (err);
+}
+
+bool
+ThreadFilter::hasAddress (eibaddr_t addr) const
+{
+  if (learned[addr] || tables->has[addr])
+    return true;
+  refresh ();
+  return false;
+}
+
+void
+ThreadFilter::addAddress (eibaddr_t addr)
+{
+  if (learned[addr])
+    return;
+  learned[addr] = true;
+
+  // tell the stack too, but nobody waits for it
+  Msg m;
+  m.kind = Msg::ADDR;
+  m.addr = addr;
+  push (*down, down_trigger, std::move (m));
+}
+
+bool
+ThreadFilter::checkAddress (eibaddr_t addr) const
+{
+  if (tables->addr_ok[addr])
+    return true;
+  refresh ();
+  return false;
+}
+
+bool
+ThreadFilter::checkGroupAddress (eibaddr_t addr) const
+{
+  if (tables->group_ok[addr])
+    return true;
+  refresh ();
+  return false;
+}
+
+void
+ThreadFilter::down_cb (ev::async &, int)
+{
+  Msg m;
+  while (down->pop (m))
+    switch (m.kind)
+      {
+      case Msg::DATA:
+        Filter::send_L_Data (std::move (m.l));
+        break;
+      case Msg::START:
+        Filter::start ();
+        break;
+      case Msg::STOP:
+        Filter::stop (m.err);
+        break;
+      case Msg::ADDR:
+        Filter::addAddress (m.addr);
+        break;
+      case Msg::REFRESH:
+        m.kind = Msg::TABLES;
+        m.tables = scan ();
+        push (*up, up_trigger, std::move (m));
+        break;
+      default:
+        break;
+      }
+}
+
+void
+ThreadFilter::recv_L_Data (LDataPtr l)
+{
+  Msg m;
+  m.kind = Msg::DATA;
+  m.l = std::move (l);
+  if (!push (*up, up_trigger, std::move (m)))
+    {
+      drops++;
+      up_trigger.send ();
+    }
+}
+
+void
+ThreadFilter::recv_L_Busmonitor (LBusmonPtr l)
+{
+  Msg m;
+  m.kind = Msg::BUSMON;
+  m.b = std::move (l);
+  if (!push (*up, up_trigger, std::move (m)))
+    {
+      drops++;
+      up_trigger.send ();
+    }
+}
+
+void
+ThreadFilter::send_Next ()
+{
+  Msg m;
+  m.kind = Msg::NEXT;
+  push (*up, up_trigger, std::move (m));
+}
+
+void
+ThreadFilter::started ()
+{
+  // Starting may have assigned addresses, e.g. a tunnel's.
+  Msg mt;
+  mt.kind = Msg::TABLES;
+  mt.tables = scan ();
+  push (*up, up_trigger, std::move (mt));
+
+  Msg m;
+  m.kind = Msg::STARTED;
+  push (*up, up_trigger, std::move (m));
+}
+
+void
+ThreadFilter::stopped (bool err)
+{
+  Msg m;
+  m.kind = Msg::STOPPED;
+  m.err = err;
+  push (*up, up_trigger, std::move (m));
+}
+
+void
+ThreadFilter::up_cb (ev::async &, int)
+{
+  if (q_pending)
+    {
+      std::lock_guard<std::mutex> g (q_lock);
+      if (q_pending)
+        {
+          q_result = q_group ? Filter::checkSysGroupAddress (q_addr)
+                             : Filter::checkSysAddress (q_addr);
+          q_pending = false;
+          q_done.notify_one ();
+        }
+    }
+
+  Msg m;
+  while (up->pop (m))
+    switch (m.kind)
+      {
+      case Msg::DATA:
+        Filter::recv_L_Data (std::move (m.l));
+        break;
+      case Msg::BUSMON:
+        Filter::recv_L_Busmonitor (std::move (m.b));
+        break;
+      case Msg::NEXT:
+        Filter::send_Next ();
+        break;
+      case Msg::STARTED:
+        Filter::started ();
+        break;
+      case Msg::STOPPED:
+        Filter::stopped (m.err);
+        break;
+      case Msg::TABLES:
+        tables = std::move (m.tables);
+        refresh_pending = false;
+        syncAddress ();
+        break;
+      default:
+        break;
+      }
+
+  unsigned long d = drops;
+  if (d != drops_seen)
+    {
+      ERRORPRINTF (t, E_WARNING | 149, "thread %s: queue full, dropped %lu frames",
+                   worker->name, d - drops_seen);
+      drops_seen = d;
+    }
+}
+
+bool
+ThreadFilter::query (bool group, eibaddr_t addr)
+{
+  if (!worker->inThread ())
+    return group ? Filter::checkSysGroupAddress (addr) : Filter::checkSysAddress (addr);
+
+  std::unique_lock<std::mutex> g (q_lock);
+  q_group = group;
+  q_addr = addr;
+  q_pending = true;
+  up_trigger.send ();
+
+  // Guessing would misroute the frame, so wait for the answer. The main
+  // loop stops answering only when it's about to stop this thread.
+  while (!q_done.wait_for (g, std::chrono::milliseconds (100), [this] { return !q_pending; }))
+    if (worker->stopping ())
+      {
+        q_pending = false;
+        ERRORPRINTF (t, E_WARNING | 151, "thread %s: stopping, address query for %s not answered",
+                     worker->name, group ? FormatGroupAddr (addr) : FormatEIBAddr (addr));
+        return false;
+      }
+  return q_result;
+}
+
+bool
+ThreadFilter::checkSysAddress (eibaddr_t addr)
+{
+  return query (false, addr);
+}
+
+bool
+ThreadFilter::checkSysGroupAddress (eibaddr_t addr)
+{
+  return query (true, addr);
+}
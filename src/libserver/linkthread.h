@@ -0,0 +1,192 @@
+/*
+    EIBD eib bus access and management daemon
+    Copyright (C) 2005-2011 Martin Koegler <mkoegler@auto.tuwien.ac.at>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef LINKTHREAD_H
+#define LINKTHREAD_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "link.h"
+#include "ring.h"
+
+/*
+ * Links with a "thread=NAME" option run their driver stack (driver and
+ * filters) on a separate event loop, in a thread of its own. All links
+ * which name the same thread share it.
+ *
+ * The LinkConnect stays on the main loop. A ThreadFilter at the top of
+ * the stack hands everything which crosses the boundary to the other
+ * side through a pair of single-producer/single-consumer rings.
+ *
+ * The drivers and filters create their watchers on their "evloop", which
+ * they copy from the LinkConnect's "stack_loop" (see Router::do_driver).
+ */
+
+class WorkerLoop;
+using WorkerLoopPtr = std::shared_ptr<WorkerLoop>;
+
+/** An event loop running in its own thread */
+class WorkerLoop
+{
+public:
+  WorkerLoop (const std::string& name, TracePtr tr);
+  ~WorkerLoop ();
+
+  std::string name;
+  struct ev_loop *loop = nullptr;
+
+  /** Start the thread. Does nothing if it's already running. */
+  bool start ();
+  /** Stop and join the thread. */
+  void stop ();
+  bool running () const
+  {
+    return thr.joinable ();
+  }
+  /** Is this the worker thread? */
+  bool inThread () const
+  {
+    return std::this_thread::get_id () == thr.get_id ();
+  }
+  /** Has stop() been called? The main loop no longer answers then. */
+  bool stopping () const
+  {
+    return stop_req;
+  }
+
+private:
+  TracePtr t;
+  std::thread thr;
+  std::atomic<bool> stop_req;
+  ev::async stop_trigger;
+  void stop_cb (ev::async &w, int revents);
+  void run ();
+};
+
+/** The boundary between a link on the main loop and its driver stack
+ * on a worker loop.
+ *
+ * Calls from above (send_L_Data, start, stop) arrive on the main thread;
+ * calls from below (recv_*, send_Next, started, stopped, checkSys*) arrive
+ * on the worker. Both are forwarded through a ring.
+ *
+ * The router's address questions (hasAddress, check*Address) need an
+ * answer right away, so they're answered on the main thread: from the
+ * addresses seen on this link, and from a copy of the stack's answers.
+ * The worker takes a fresh copy when the stack has started, and when
+ * the main thread asks for one because a lookup failed.
+ */
+class ThreadFilter : public Filter
+{
+public:
+  ThreadFilter (const LinkConnectPtr_& c, IniSectionPtr& s, WorkerLoopPtr w);
+  virtual ~ThreadFilter () = default;
+
+  virtual const std::string& name ();
+  virtual bool setup ();
+
+  /* main thread */
+  virtual void send_L_Data (LDataPtr l);
+  virtual void start ();
+  virtual void stop (bool err);
+  virtual bool hasAddress (eibaddr_t addr) const;
+  virtual void addAddress (eibaddr_t addr);
+  virtual bool checkAddress (eibaddr_t addr) const;
+  virtual bool checkGroupAddress (eibaddr_t addr) const;
+
+  /* worker thread */
+  virtual void recv_L_Data (LDataPtr l);
+  virtual void recv_L_Busmonitor (LBusmonPtr l);
+  virtual void send_Next ();
+  virtual void started ();
+  virtual void stopped (bool err);
+  virtual bool checkSysAddress (eibaddr_t addr);
+  virtual bool checkSysGroupAddress (eibaddr_t addr);
+
+private:
+  /** the stack's answers, by address */
+  struct Tables
+  {
+    std::vector<bool> has, addr_ok, group_ok;
+  };
+  /** ask the stack. Only on the thread it runs on. */
+  std::shared_ptr<Tables> scan ();
+
+  struct Msg
+  {
+    enum Kind : uint8_t { NONE, DATA, BUSMON, NEXT, START, STOP, STARTED, STOPPED, ADDR, REFRESH, TABLES };
+    Kind kind = NONE;
+    bool err = false;
+    eibaddr_t addr = 0;
+    LDataPtr l;
+    LBusmonPtr b;
+    std::shared_ptr<Tables> tables;
+  };
+
+
+  WorkerLoopPtr worker;
+
+  /** main => worker */
+  std::unique_ptr<SpscRing<Msg>> down;
+  mutable ev::async down_trigger;
+  void down_cb (ev::async &w, int revents);
+
+  /** worker => main */
+  std::unique_ptr<SpscRing<Msg>> up;
+  ev::async up_trigger;
+  void up_cb (ev::async &w, int revents);
+  /** ring slots kept free for control messages */
+  static const size_t reserve = 16;
+
+  /** Frames dropped because a ring was full. Counted by the producer,
+   * reported on the main thread. */
+  std::atomic<unsigned long> drops;
+  unsigned long drops_seen = 0;
+
+  /** main thread: the latest copy of the stack's answers */
+  std::shared_ptr<Tables> tables;
+  /** main thread: addresses the router has added */
+  std::vector<bool> learned;
+  /** main thread: a lookup failed. Ask for a new copy, at most once a
+   * second. */
+  void refresh () const;
+  mutable bool refresh_pending = false;
+  mutable timestamp_t refresh_time = 0;
+  /** main thread: the link's address, as the router has indexed it.
+   * Drivers may assign it on the worker. */
+  eibaddr_t indexed_addr = 0;
+  void syncAddress ();
+
+  /* checkSys*Address() needs an answer from the router, which lives on
+   * the main thread. The worker waits for it. */
+  std::mutex q_lock;
+  std::condition_variable q_done;
+  std::atomic<bool> q_pending;
+  bool q_group = false;
+  eibaddr_t q_addr = 0;
+  bool q_result = false;
+  bool query (bool group, eibaddr_t addr);
+
+  static bool push (SpscRing<Msg>& r, ev::async& trigger, Msg&& m);
+};
+
+#endif
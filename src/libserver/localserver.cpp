@@ -89,7 +89,7 @@ ex:
         }
     }
 
-  if (listen (fd, 10) == -1)
+  if (listen (fd, SOMAXCONN) == -1)
     {
       ERRORPRINTF (t, E_ERROR | 17, "OpenLocalSocket %s: listen: %s", path, strerror(errno));
       goto ex2;
@@ -33,9 +33,10 @@ LowLevelIface::~LowLevelIface()
   local_timeout.stop();
 }
 
-LowLevelIface::LowLevelIface()
+LowLevelIface::LowLevelIface(struct ev_loop *loop) : evloop(loop)
 {
   sendLocal_done.set<LowLevelIface,&LowLevelIface::sendLocal_done_cb>(this);
+  local_timeout.set (loop);
   local_timeout.set<LowLevelIface,&LowLevelIface::local_timeout_cb>(this);
 }
 
@@ -156,8 +157,8 @@ void
 FDdriver::setup_buffers()
 {
   TRACEPRINTF (t, 2, "Buffer Setup on fd %d", fd);
-  sendbuf.init(fd);
-  recvbuf.init(fd);
+  sendbuf.init(evloop, fd);
+  recvbuf.init(evloop, fd);
   recvbuf.low_latency();
 
   recvbuf.on_read.set<FDdriver,&FDdriver::read_cb>(this);
@@ -76,9 +76,12 @@ class _cls : public _base
 class LowLevelIface
 {
 public:
-  LowLevelIface();
+  LowLevelIface(struct ev_loop *loop);
   virtual ~LowLevelIface();
 
+  /** the event loop of the driver stack this belongs to */
+  struct ev_loop *evloop;
+
   virtual TracePtr tr() const = 0;
   virtual void started() = 0;
   virtual void stopped(bool err) = 0;
@@ -170,7 +173,8 @@ public:
     return t;
   }
 
-  LowLevelDriver (LowLevelIface* parent, IniSectionPtr& s) : cfg(s)
+  LowLevelDriver (LowLevelIface* parent, IniSectionPtr& s)
+    : LowLevelIface(parent->evloop), cfg(s)
   {
     t = TracePtr(new Trace(*parent->tr(),s));
     t->setAuxName("LowD");
@@ -343,12 +347,14 @@ protected:
 class LowLevelAdapter : public HWBusDriver, public LowLevelIface
 {
 public:
+  using HWBusDriver::evloop;
+
   TracePtr tr() const
   {
     return t;
   }
 
-  LowLevelAdapter(const LinkConnectPtr_& c, IniSectionPtr& s) : HWBusDriver(c,s),LowLevelIface()
+  LowLevelAdapter(const LinkConnectPtr_& c, IniSectionPtr& s) : HWBusDriver(c,s),LowLevelIface(c->stack_loop)
   {
     t->setAuxName("LowA");
   }
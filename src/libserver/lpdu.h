@@ -29,6 +29,7 @@
 
 #include <memory>
 
+#include "pool.h"
 #include "trace.h"
 
 /** Message Priority */
@@ -119,6 +120,11 @@ public:
    * because irrelevant. */
   void *source = nullptr;
 
+  /** when the frame arrived at knxd, see L_Data_Stamp(); 0 if unknown */
+  timestamp_t ingress = 0;
+  /** position of the link it arrived on. Only valid within the router. */
+  int ingress_link = -1;
+
   L_Data_PDU () = default;
 
   virtual std::string Decode (TracePtr tr) const override;
@@ -128,7 +134,33 @@ public:
   }
 };
 
-using LDataPtr = std::unique_ptr<L_Data_PDU>;
+/** L_Data frames are reference counted so that the router can hand the
+ * same frame to every recipient. A frame that has been passed on must be
+ * treated as read-only; code which modifies a frame it did not create
+ * calls L_Data_Unshare() first. */
+using LDataPtr = std::shared_ptr<L_Data_PDU>;
+
+/** allocate a frame from the current loop's pool */
+template<typename... _Args>
+inline LDataPtr L_Data_New (_Args&&... args)
+{
+  return std::allocate_shared<L_Data_PDU> (PoolAllocator<L_Data_PDU>(),
+                                           std::forward<_Args>(args)...);
+}
+
+/** Note that @l just arrived, unless a driver already did that */
+inline void L_Data_Stamp (L_Data_PDU &l)
+{
+  if (!l.ingress)
+    l.ingress = getMonotonicTime ();
+}
+
+/** make @l private to the caller, copying it if it is shared */
+inline void L_Data_Unshare (LDataPtr &l)
+{
+  if (!l.unique())
+    l = L_Data_New (*l);
+}
 
 /* L_SystemBroadcast */
 
@@ -209,6 +241,17 @@ public:
   CArray lpdu;
   uint32_t time_stamp;
 
+  /** Client messages for this frame (see A_Busmonitor). They are built
+   * on first use and then shared by all clients. */
+  enum ClientMessage
+  {
+    MSG_PLAIN,
+    MSG_TS,
+    MSG_TEXT,
+    MSG_MAX
+  };
+  mutable CArray client_msg[MSG_MAX];
+
   L_Busmon_PDU ();
 
   virtual std::string Decode (TracePtr tr) const override;
@@ -218,7 +261,17 @@ public:
   }
 };
 
-using LBusmonPtr = std::unique_ptr<L_Busmon_PDU>;
+/** Like L_Data frames, busmonitor frames are shared by all recipients
+ * and must not be modified once they have been passed on. */
+using LBusmonPtr = std::shared_ptr<L_Busmon_PDU>;
+
+/** allocate a busmonitor frame from the current loop's pool */
+template<typename... _Args>
+inline LBusmonPtr L_Busmon_New (_Args&&... args)
+{
+  return std::allocate_shared<L_Busmon_PDU> (PoolAllocator<L_Busmon_PDU>(),
+                                             std::forward<_Args>(args)...);
+}
 
 /** interface for callback for busmonitor frames */
 class L_Busmonitor_CallBack
@@ -0,0 +1,135 @@
+/*
+    EIBD eib bus access and management daemon
+    Copyright (C) 2005-2011 Martin Koegler <mkoegler@auto.tuwien.ac.at>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#ifndef PRIOQUEUE_H
+#define PRIOQUEUE_H
+
+#include "common.h"
+#include "lpdu.h"
+#include "queue.h"
+
+/** Per-priority statistics of a LDataQueue */
+struct PrioQueueStats
+{
+  /** frames which went through the queue */
+  unsigned long count = 0;
+  /** total and maximum time spent in the queue, µs */
+  timestamp_t total = 0;
+  timestamp_t max = 0;
+};
+
+/** A queue for L_Data frames which honors their priority.
+ *
+ * System and urgent frames are sent strictly first. Normal and low
+ * priority frames share the rest: while both are waiting, @weight normal
+ * frames are sent for each low-priority one, so that a bulk transfer
+ * at low priority can neither block nor be starved by normal traffic.
+ */
+class LDataQueue
+{
+  struct Entry
+  {
+    LDataPtr l;
+    timestamp_t queued;
+  };
+  Queue<Entry> q[4];
+  size_t len = 0;
+  /** normal-priority frames sent since the last low-priority one */
+  unsigned int run = 0;
+
+public:
+  /** normal-priority frames per low-priority frame */
+  unsigned int weight = 4;
+
+  PrioQueueStats stats[4];
+
+  size_t size() const
+  {
+    return len;
+  }
+  bool empty() const
+  {
+    return len == 0;
+  }
+  void clear()
+  {
+    for (int i = 0; i < 4; i++)
+      q[i].clear();
+    len = 0;
+    run = 0;
+  }
+
+  void put (LDataPtr && l)
+  {
+    int p = l->priority & 3;
+    q[p].put (Entry { std::move(l), getMonotonicTime () });
+    len++;
+  }
+  void emplace (LDataPtr && l)
+  {
+    put (std::move(l));
+  }
+
+  LDataPtr get ()
+  {
+    int p;
+    if (!q[PRIO_SYSTEM].empty())
+      p = PRIO_SYSTEM;
+    else if (!q[PRIO_URGENT].empty())
+      p = PRIO_URGENT;
+    else if (q[PRIO_LOW].empty())
+      p = PRIO_NORMAL;
+    else if (q[PRIO_NORMAL].empty() || run >= weight)
+      p = PRIO_LOW;
+    else
+      p = PRIO_NORMAL;
+
+    if (p == PRIO_NORMAL)
+      run++;
+    else if (p == PRIO_LOW)
+      run = 0;
+
+    Entry e = q[p].get ();
+    len--;
+
+    timestamp_t d = getMonotonicTime () - e.queued;
+    PrioQueueStats& s = stats[p];
+    s.count++;
+    s.total += d;
+    if (s.max < d)
+      s.max = d;
+    return std::move(e.l);
+  }
+
+  /** log the latency counters */
+  void traceStats (TracePtr t, const char *what) const
+  {
+    static const char *const names[4] = { "system", "urgent", "normal", "low" };
+    for (int i = 0; i < 4; i++)
+      {
+        const PrioQueueStats& s = stats[i];
+        if (!s.count)
+          continue;
+        TRACEPRINTF (t, 4, "%s %s: %lu frames, latency avg %lld max %lld µs",
+                     what, names[i], s.count, s.total / s.count, s.max);
+      }
+  }
+};
+
+#endif
@@ -21,7 +21,9 @@
 
 RetryFilter::RetryFilter (const LinkConnectPtr_& c, IniSectionPtr& s) : Filter(c,s)
 {
+  trigger.set (evloop);
   trigger.set<RetryFilter, &RetryFilter::trigger_cb>(this);
+  timeout.set (evloop);
   timeout.set<RetryFilter, &RetryFilter::timeout_cb>(this);
   trigger.start();
   state = R_DOWN;
@@ -105,7 +107,7 @@ RetryFilter::send_L_Data (LDataPtr l)
         ERRORPRINTF(t, E_WARNING | 137, "spurious send");
       else
         {
-          msg = LDataPtr(new L_Data_PDU (*l));
+          msg = l;
           timeout.start(send_timeout, 0);
           Filter::send_L_Data(std::move(l));
         }
@@ -235,7 +237,7 @@ RetryFilter::trigger_cb (ev::async &, int)
 
     case R_UP:
       if (msg)
-        Filter::send_L_Data(LDataPtr(new L_Data_PDU (*msg)));
+        Filter::send_L_Data(msg);
       break;
 
     default:
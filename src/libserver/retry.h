@@ -64,7 +64,7 @@ FILTER(RetryFilter, retry)
   int send_retries = 0;
   // count failing attempts to restart
   int start_retries = 0;
-  // storage for in-flight transmitted message
+  // in-flight transmitted message, shared with the driver
   LDataPtr msg = nullptr;
 
   // internal stop handler
@@ -19,10 +19,15 @@
 
 #include "router.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <math.h>
 #include <sys/socket.h>
 #include <typeinfo>
+#include <unistd.h>
 
 #include <ev++.h>
 #ifdef HAVE_SYSTEMD
@@ -174,6 +179,7 @@ Router::Router (IniData& d, std::string sn) : BaseRouter(d)
   IniSectionPtr s = ini[main];
   t = TracePtr(new Trace(s, s->value("name","")));
   servername = s->value("name","knxd");
+  addr_links.resize(65536);
 
   r_low = RouterLowPtr(new RouterLow(*this));
   r_high = RouterHighPtr(new RouterHigh(*this, r_low));
@@ -185,6 +191,7 @@ Router::Router (IniData& d, std::string sn) : BaseRouter(d)
   trigger.start();
   mtrigger.start();
   state_trigger.start();
+  stats_timer.set<Router, &Router::stats_timer_cb>(this);
 
   TRACEPRINTF (t, 4, "initialized");
 }
@@ -198,6 +205,16 @@ Router::setup()
 
   force_broadcast = s->value("force-broadcast", false);
   unknown_ok = s->value("unknown-ok", false);
+  buf.weight = s->value("prio-weight", (int)buf.weight);
+  ignore.setup (s->value("repeat-window", 1.0) * 1000000,
+                s->value("repeat-window-size", 1024));
+  latency_stats = s->value("latency-stats", false);
+  stats_file = s->value("stats-file", "");
+  if (stats_file.size())
+    {
+      double iv = s->value("stats-interval", 60.);
+      stats_timer.start(iv, iv);
+    }
 
   x = s->value("addr","");
   if (!x.size())
@@ -214,9 +231,9 @@ Router::setup()
       if (!readaddrblock(x,client_addrs_start,client_addrs_len))
         goto ex;
       client_addrs_pos = client_addrs_len-1;
-      client_addrs.resize(client_addrs_len);
-      ITER(i,client_addrs)
-      *i = false;
+      client_addrs_free.assign((client_addrs_len+63)/64, 0);
+      for (int i = 0; i < client_addrs_len; i++)
+        client_addrs_free[i>>6] |= uint64_t(1) << (i&63);
     }
 
 #ifdef HAVE_GROUPCACHE
@@ -270,26 +287,13 @@ Router::setup()
 
 #endif
 
-  x = s->value("connections","");
-  {
-    size_t pos = 0;
-    size_t comma = 0;
-    while(true)
-      {
-        comma = x.find(',',pos);
-        std::string name = x.substr(pos,comma-pos);
-        if (name.size())
-          {
-            LinkConnectPtr link = setup_link(name);
-            if (link == nullptr)
-              goto ex;
-            registerLink(link);
-          }
-        if (comma == std::string::npos)
-          break;
-        pos = comma+1;
-      }
-  }
+  for (auto& name : connectionList(s))
+    {
+      LinkConnectPtr link = setup_link(name);
+      if (link == nullptr)
+        goto ex;
+      registerLink(link);
+    }
 
   if (links.size() == 0)
     {
@@ -315,6 +319,113 @@ ex:
   return false;
 }
 
+std::vector<std::string>
+Router::connectionList(IniSectionPtr& s)
+{
+  std::vector<std::string> res;
+  std::string x = s->value("connections","");
+  size_t pos = 0;
+  while(true)
+    {
+      size_t comma = x.find(',',pos);
+      std::string name = x.substr(pos,comma-pos);
+      if (name.size())
+        res.push_back(name);
+      if (comma == std::string::npos)
+        break;
+      pos = comma+1;
+    }
+  return res;
+}
+
+bool
+Router::reload(IniData& nd)
+{
+  bool ok = true;
+  IniSectionPtr om = ini[main];
+  IniSectionPtr nm = nd[main];
+  TRACEPRINTF (t, 4, "reloading");
+
+  if (!ini.same(nd, main, "connections"))
+    ERRORPRINTF (t, E_WARNING | 161, "Section '%s' has changed. Only changes to 'connections' take effect without a restart.", main);
+
+  std::vector<std::string> old_names = connectionList(om);
+  std::vector<std::string> new_names = connectionList(nm);
+  auto listed = [](const std::vector<std::string>& v, const std::string& n)
+  {
+    return std::find(v.begin(), v.end(), n) != v.end();
+  };
+
+  // decide first, as update() forgets the old settings
+  std::vector<LinkConnectPtr> gone;
+  std::vector<std::string> keep;
+  ITER(i,links)
+  {
+    LinkConnectPtr& link = i->second;
+    if (link->transient)
+      continue;
+    const std::string& n = link->cfg->name;
+    if (!listed(old_names, n))
+      continue; // from systemd
+    bool still = listed(new_names, n);
+    if (still && ini.same(nd, n))
+      {
+        keep.push_back(n);
+        continue;
+      }
+    if (link->cfg->value("thread","").size() || (still && nd[n]->value("thread","").size()))
+      {
+        ERRORPRINTF (link->t, E_WARNING | 162, "%s: threaded links can't be reloaded, restart knxd", n);
+        keep.push_back(n);
+        continue;
+      }
+    gone.push_back(link);
+  }
+
+  ini.update(nd);
+  om = ini[main];
+  new_names = connectionList(om); // marks the new value as seen
+
+  int n_new = 0, n_gone = 0;
+  ITER(i,gone)
+  {
+    LinkConnectPtr link = *i;
+    ERRORPRINTF (link->t, E_INFO | 163, "Disconnected: %s.", link->info(2));
+    link->setState(L_going_down);
+    unregisterLink(link);
+    // still needed until it has stopped
+    retired.push_back(link);
+    n_gone++;
+  }
+
+  for (auto& name : new_names)
+    {
+      if (listed(keep, name))
+        continue;
+      LinkConnectPtr link = setup_link(name);
+      if (link == nullptr)
+        {
+          ok = false;
+          continue;
+        }
+      registerLink(link);
+      ERRORPRINTF (link->t, E_INFO | 129, "Connected: %s.", link->info(2));
+      n_new++;
+    }
+
+  // a typo must not kill a running server
+  bool uo = unknown_ok;
+  unknown_ok = true;
+  ini.list_unseen(&unseen_lister, (void *)this);
+  unknown_ok = uo;
+
+  ERRORPRINTF (t, E_INFO | 164, "Reloaded: %d links started, %d stopped, %zu unchanged",
+               n_new, n_gone, keep.size());
+  if (links.size() < 2)
+    ERRORPRINTF (t, E_WARNING | 165, "Only %zu connections left in section '%s'.", links.size(), main);
+  return ok;
+}
+
 bool
 unseen_lister(void *user,
               const IniSection& section, const std::string& name, const std::string& value)
@@ -330,7 +441,22 @@ Router::do_driver(LinkConnectPtr &link, IniSectionPtr& s, const std::string& dri
 {
   DriverPtr driver = nullptr;
 
+  WorkerLoopPtr worker = nullptr;
+
   link = LinkConnectPtr(new LinkConnect(*this, s, t));
+
+  std::string tn = s->value("thread","");
+  if (tn.size())
+    {
+      worker = get_worker(tn);
+      if (worker == nullptr)
+        {
+          link = nullptr;
+          return true;
+        }
+      link->stack_loop = worker->loop;
+    }
+
   driver = DriverPtr(drivers.create(drivername, link, s));
   if (driver == nullptr)
     {
@@ -341,10 +467,47 @@ Router::do_driver(LinkConnectPtr &link, IniSectionPtr& s, const std::string& dri
     }
   link->set_driver(driver);
   if (!link->setup())
-    link = nullptr;
+    {
+      link = nullptr;
+      return true;
+    }
+
+  if (worker != nullptr)
+    {
+      FilterPtr f = FilterPtr(new ThreadFilter(link, s, worker));
+      if (!driver->push_filter(f, true) || !f->setup())
+        {
+          ERRORPRINTF (t, E_ERROR | 152, "%s: could not move to thread %s", s->name, tn);
+          link = nullptr;
+        }
+    }
   return true;
 }
 
+WorkerLoopPtr
+Router::get_worker(const std::string& name)
+{
+  auto w = workers.find(name);
+  if (w != workers.end())
+    {
+      if (w->second->running())
+        {
+          ERRORPRINTF (t, E_ERROR | 153, "thread %s is already running, can't add links to it", name);
+          return nullptr;
+        }
+      return w->second;
+    }
+
+  WorkerLoopPtr wl = WorkerLoopPtr(new WorkerLoop(name, t));
+  if (wl->loop == nullptr)
+    {
+      ERRORPRINTF (t, E_ERROR | 154, "thread %s: could not create an event loop", name);
+      return nullptr;
+    }
+  workers[name] = wl;
+  return wl;
+}
+
 
 FilterPtr
 Router::get_filter(const LinkConnectPtr_& link, IniSectionPtr& s, const std::string& filtername)
@@ -443,21 +606,8 @@ Router::send_Next()
       TRACEPRINTF (t, 6, "send_more set");
       return;
     }
-  ITER(i,links)
-  {
-    auto ii = i->second;
-    if (ii->state != L_up)
-      {
-        TRACEPRINTF (ii->t, 6, "not up");
-        continue;
-      }
-    if (!ii->send_more)
-      {
-        TRACEPRINTF (ii->t, 6, "still waiting");
-        return;
-      }
-    TRACEPRINTF (ii->t, 6, "is OK");
-  }
+  // Links queue whatever they can't send right now, so there is no
+  // need to wait for any of them.
   TRACEPRINTF (t, 6, "OK");
   high_send_more = true;
   r_high->send_Next();
@@ -491,6 +641,12 @@ Router::state_trigger_cb (ev::async &, int)
         l->setState(L_going_down);
     }
 
+  retired.erase(std::remove_if(retired.begin(), retired.end(),
+                               [](const LinkConnectPtr& l)
+  {
+    return l->state == L_down || l->state == L_error;
+  }), retired.end());
+
   ITER(i,links)
   {
     auto ii = i->second;
@@ -642,6 +798,17 @@ void
 Router::stopped(bool err)
 {
   TRACEPRINTF (t, 4, "down");
+  TRACEPRINTF (t, 4, "repeat window: %lu dropped, %lu passed, %lu evicted",
+               ignore.hits, ignore.misses, ignore.evicted);
+  buf.traceStats (t, "ingress");
+  {
+    BlockPool& dp = BlockPool::local<L_Data_PDU>();
+    BlockPool& mp = BlockPool::local<L_Busmon_PDU>();
+    TRACEPRINTF (t, 4, "frame pool: %lu hits, %lu misses, max %ld in use",
+                 dp.hits, dp.misses, dp.high_water);
+    TRACEPRINTF (t, 4, "busmonitor pool: %lu hits, %lu misses, max %ld in use",
+                 mp.hits, mp.misses, mp.high_water);
+  }
   if (want_up)
     stop(err);
   else
@@ -655,6 +822,7 @@ Router::~Router()
   trigger.stop();
   mtrigger.stop();
   state_trigger.stop();
+  stats_timer.stop();
 
   R_ITER(i,vbusmonitor)
   ERRORPRINTF (t, E_WARNING | 55, "VBusmonitor '%s' didn't de-register!", i->cb->name);
@@ -664,6 +832,10 @@ Router::~Router()
   ERRORPRINTF (t, E_WARNING | 56, "Busmonitor '%s' didn't de-register!", i->cb->name);
   busmonitor.clear();
 
+  // driver stacks may only be torn down once their loops are idle
+  ITER(i,workers)
+    i->second->stop();
+
 //  ITER(i,links)
 //    delete i->second;
   links.clear();
@@ -680,8 +852,10 @@ Router::recv_L_Data (LDataPtr l, LinkConnect& link)
     {
       // Common problem with things that are not true gateways
       ERRORPRINTF (link.t, E_WARNING | 57, "Message without destination. Use the single-node filter ('-B single')?");
+      stats.drop_no_dest++;
       return;
     }
+  L_Data_Unshare (l);
 
   // Unassigned source: set to link's, or our, address
   if (l->source_address == 0)
@@ -698,6 +872,7 @@ Router::recv_L_Data (LDataPtr l, LinkConnect& link)
         {
           // Nope. Reject.
           TRACEPRINTF (link.t, 3, "Packet not from us");
+          stats.drop_not_from_us++;
           return;
         }
     }
@@ -707,20 +882,30 @@ Router::recv_L_Data (LDataPtr l, LinkConnect& link)
       if (&*l2x != &link)
         {
           TRACEPRINTF (link.t, 3, "Packet not from %d:%s: %s", l2x->t->seq, l2x->t->name, l->Decode (t));
+          stats.drop_not_from_us++;
           return;
         }
     }
   else if (client_addrs_len && l->source_address >= client_addrs_start && l->source_address < client_addrs_start+client_addrs_len)
     {
       TRACEPRINTF (link.t, 3, "Packet originally from closed local interface");
+      stats.drop_not_from_us++;
       return;
     }
   else if (l->source_address != 0xFFFF)   // don't assign the "unprogrammed" address
     {
       link.addAddress (l->source_address);
+      addAddress (l->source_address, link);
     }
 
   l->source = &link;
+  if (latency_stats)
+    {
+      L_Data_Stamp (*l);
+      // clients come and go, so they share a histogram
+      l->ingress_link = link.transient ? -1 : link.pos;
+    }
+  stats.rx_frames++;
   r_high->recv_L_Data(std::move(l));
 }
 
@@ -736,11 +921,16 @@ Router::queue_L_Data (LDataPtr l)
   if (some_running || want_up)
     {
       buf.emplace (std::move(l));
+      if (buf.size() > stats.queue_high)
+        stats.queue_high = buf.size();
       if (running_signal)
         trigger.send();
     }
   else
-    TRACEPRINTF (t, 9, "Queue: discard (not running) %s", l->Decode (t));
+    {
+      TRACEPRINTF (t, 9, "Queue: discard (not running) %s", l->Decode (t));
+      stats.drop_not_running++;
+    }
 }
 
 void
@@ -827,6 +1017,9 @@ Router::registerLink(const LinkConnectPtr& link, bool transient)
     }
   TRACEPRINTF (link->t, 3, "registerLink: %d:%s", link->pos,n);
   links_changed = true;
+  if (link->addr)
+    addAddress (link->addr, *link);
+  indexGroups (*link, true);
   if (transient)
     link->transient = true;
   if (want_up)
@@ -849,7 +1042,9 @@ Router::unregisterLink(const LinkConnectPtr& link)
       ERRORPRINTF (link->t, E_ERROR | 94, "unregisterLink: %d:%s: not present", link->pos,n);
       return false;
     }
+  indexGroups (*link, false);
   links.erase(res);
+  dropAddresses (*link);
   TRACEPRINTF (link->t, 3, "unregisterLink: %s", n);
   links_changed = true;
   if (!in_link_loop)
@@ -874,28 +1069,145 @@ Router::hasAddress (eibaddr_t addr, LinkConnectPtr& link, bool quiet) const
       return false;
     }
 
-  C_ITER(i, links)
-  {
-    if (i->second == link)
-      continue;
-    if (i->second->hasAddress (addr))
+  LinkConnect *l = addr_links[addr];
+  if (l == nullptr)
+    {
+      if (!quiet)
+        TRACEPRINTF (t, 8, "unknown addr %s", FormatEIBAddr (addr));
+      return false;
+    }
+  if (l == link.get())
+    {
+      if (!quiet)
+        TRACEPRINTF (link->t, 8, "local addr %s", FormatEIBAddr (addr));
+      return false;
+    }
+  if (!quiet)
+    TRACEPRINTF (l->t, 8, "found addr %s", FormatEIBAddr (addr));
+  link = std::static_pointer_cast<LinkConnect>(l->shared_from_this());
+  return true;
+}
+
+void
+Router::addAddress (eibaddr_t addr, LinkConnect& link)
+{
+  LinkConnect *&l = addr_links[addr];
+  if (l == &link)
+    return;
+  if (!isRegistered(link))
+    return;
+  if (l != nullptr)
+    {
+      TRACEPRINTF (link.t, 8, "addr %s moved from %s", FormatEIBAddr (addr), l->t->name);
+      l->routed_addrs.erase(addr);
+    }
+  l = &link;
+  link.routed_addrs.insert(addr);
+}
+
+bool
+Router::isRegistered (const LinkConnect& link) const
+{
+  auto res = links.find(link.pos);
+  return res != links.end() && &*res->second == &link;
+}
+
+void
+Router::indexGroups (LinkConnect& link, bool on)
+{
+  if (!isRegistered(link))
+    return;
+  if (link.groups_all)
+    {
+      if (on)
+        group_all.push_back(&link);
+      else
+        unlistGroupLink(group_all, &link);
+    }
+  else
+    ITER(i, link.groups)
+    indexGroup(link, *i, on);
+}
+
+void
+Router::indexGroup (LinkConnect& link, eibaddr_t ga, bool on)
+{
+  if (!isRegistered(link))
+    return;
+  if (on)
+    group_links[ga].push_back(&link);
+  else
+    {
+      auto gl = group_links.find(ga);
+      if (gl == group_links.end())
+        return;
+      unlistGroupLink(gl->second, &link);
+      if (gl->second.empty())
+        group_links.erase(gl);
+    }
+}
+
+void
+Router::unlistGroupLink (std::vector<LinkConnect *>& v, LinkConnect *link)
+{
+  for (auto i = v.begin(); i != v.end(); i++)
+    if (*i == link)
       {
-        if (i->second == link)
+        if (high_sending)
           {
-            if (!quiet)
-              TRACEPRINTF (link->t, 8, "local addr %s", FormatEIBAddr (addr));
-            return false;
+            // send_L_Data is walking this list. Clean up later.
+            *i = nullptr;
+            groups_dirty = true;
           }
-        if (!quiet)
-          TRACEPRINTF (i->second->t, 8, "found addr %s", FormatEIBAddr (addr));
-        link = i->second;
-        return true;
+        else
+          v.erase(i);
+        return;
       }
-  }
+}
 
-  if (!quiet)
-    TRACEPRINTF (t, 8, "unknown addr %s", FormatEIBAddr (addr));
-  return false;
+void
+Router::compactGroups ()
+{
+  groups_dirty = false;
+  group_all.erase(std::remove(group_all.begin(), group_all.end(), nullptr), group_all.end());
+  for (auto gl = group_links.begin(); gl != group_links.end(); )
+    {
+      auto& v = gl->second;
+      v.erase(std::remove(v.begin(), v.end(), nullptr), v.end());
+      if (v.empty())
+        gl = group_links.erase(gl);
+      else
+        gl++;
+    }
+}
+
+void
+Router::dropAddresses (LinkConnect& link)
+{
+  std::unordered_set<eibaddr_t> addrs;
+  addrs.swap(link.routed_addrs);
+  ITER(a, addrs)
+  dropAddress (*a, link);
+}
+
+void
+Router::dropAddress (eibaddr_t addr, LinkConnect& link)
+{
+  link.routed_addrs.erase(addr);
+  if (addr_links[addr] != &link)
+    return;
+  addr_links[addr] = nullptr;
+
+  // Some other link might know this address too.
+  ITER(i, links)
+  {
+    auto ii = i->second;
+    if (&*ii != &link && linkHasAddress(&*ii, addr))
+      {
+        addAddress (addr, *ii);
+        break;
+      }
+  }
 }
 
 bool
@@ -904,9 +1216,14 @@ Router::checkAddress (eibaddr_t addr, LinkConnectPtr link) const
   if (addr == 0) // always accept broadcast
     return true;
 
+  // fast path: the link this address has been seen on
+  LinkConnect *l = addr_links[addr];
+  if (l != nullptr && l != link.get() && l->checkAddress (addr))
+    return true;
+
   C_ITER(i, links)
   {
-    if (i->second == link)
+    if (i->second == link || i->second.get() == l)
       continue;
     if (i->second->checkAddress (addr))
       return true;
@@ -921,17 +1238,39 @@ Router::checkGroupAddress (eibaddr_t addr, LinkConnectPtr link) const
   if (addr == 0) // always accept broadcast
     return true;
 
-  C_ITER(i, links)
+  auto gl = group_links.find(addr);
+  if (gl != group_links.end())
+    for (auto i = gl->second.cbegin(); i != gl->second.cend(); i++)
+      if (*i != nullptr && *i != link.get())
+        return true;
+
+  C_ITER(i, group_all)
   {
-    if (i->second == link)
+    if (*i == nullptr || *i == link.get())
       continue;
-    if (i->second->checkGroupAddress (addr))
+    if ((*i)->checkGroupAddress (addr))
       return true;
   }
 
   return false;
 }
 
+int
+Router::nextFreeClientAddr (int from, int to) const
+{
+  while (from < to)
+    {
+      uint64_t w = client_addrs_free[from>>6] >> (from&63);
+      if (w)
+        {
+          int pos = from + __builtin_ctzll (w);
+          return pos < to ? pos : -1;
+        }
+      from = (from|63) + 1;
+    }
+  return -1;
+}
+
 eibaddr_t
 Router::get_client_addr (TracePtr t)
 {
@@ -942,21 +1281,28 @@ Router::get_client_addr (TracePtr t)
    *
    * client_addrs_pos is set to len-1 in set_client_block() so that allocation
    * still starts at the first free address when starting up.
+   *
+   * Free positions are found by scanning the bitmap a word at a time;
+   * whether somebody else uses the address is a lookup in the router's
+   * address index.
    */
-  for (int i = 1; i <= client_addrs_len; i++)
+  int start = client_addrs_pos + 1;
+  for (int pass = 0; pass < 2; pass++)
     {
-      unsigned int pos = (client_addrs_pos + i) % client_addrs_len;
-      if (client_addrs[pos])
-        continue;
-      eibaddr_t a = client_addrs_start + pos;
-      LinkConnectPtr link = nullptr;
-      if (a != addr && !hasAddress (a, link, true))
+      int to = pass ? start : client_addrs_len;
+      for (int pos = nextFreeClientAddr (pass ? 0 : start, to); pos >= 0;
+           pos = nextFreeClientAddr (pos+1, to))
         {
-          TRACEPRINTF (t, 3, "Allocate %s", FormatEIBAddr (a));
-          /* remember for next pass */
-          client_addrs_pos = pos;
-          client_addrs[pos] = true;
-          return a;
+          eibaddr_t a = client_addrs_start + pos;
+          LinkConnectPtr link = nullptr;
+          if (a != addr && !hasAddress (a, link, true))
+            {
+              TRACEPRINTF (t, 3, "Allocate %s", FormatEIBAddr (a));
+              /* remember for next pass */
+              client_addrs_pos = pos;
+              client_addrs_free[pos>>6] &= ~(uint64_t(1) << (pos&63));
+              return a;
+            }
         }
     }
 
@@ -979,14 +1325,15 @@ Router::release_client_addr(eibaddr_t addr)
       ERRORPRINTF (t, E_ERROR | 95, "Release BAD2 %s", FormatEIBAddr (addr));
       return;
     }
-  if (!client_addrs[pos])
+  uint64_t bit = uint64_t(1) << (pos&63);
+  if (client_addrs_free[pos>>6] & bit)
     {
       ERRORPRINTF (t, E_ERROR | 96, "Release free addr %s", FormatEIBAddr (addr));
       return;
     }
 
   TRACEPRINTF (t, 3, "Release %s", FormatEIBAddr (addr));
-  client_addrs[pos] = false;
+  client_addrs_free[pos>>6] |= bit;
 }
 
 void
@@ -998,41 +1345,43 @@ Router::trigger_cb (ev::async &, int)
 
       if (vbusmonitor.size())
         {
-          LBusmonPtr l2 = LBusmonPtr(new L_Busmon_PDU ());
+          LBusmonPtr l2 = L_Busmon_New ();
           l2->lpdu.set (L_Data_to_CM_TP1 (l1));
 
           ITER(i,vbusmonitor)
-          i->cb->send_L_Busmonitor (LBusmonPtr(new L_Busmon_PDU (*l2)));
+          i->cb->send_L_Busmonitor (l2);
         }
       if (!l1->hop_count)
         {
           TRACEPRINTF (t, 3, "Hopcount zero: %s", l1->Decode (t));
+          stats.drop_hop_count++;
           goto next;
         }
+      L_Data_Unshare (l1);
       if (l1->hop_count < 7 || !force_broadcast)
         l1->hop_count--;
 
-      if (l1->repeated)
-        {
-          CArray d1 = L_Data_to_CM_TP1 (l1);
-          ITER (i,ignore)
-          if (d1 == i->data)
-            {
-              TRACEPRINTF (t, 9, "Drop: %s", l1->Decode (t));
-              goto next;
-            }
-        }
-      l1->repeated = 1;
-      ignore.push_back((IgnoreInfo)
       {
-        .data = L_Data_to_CM_TP1 (l1), .end = getTime () + 1000000
-      });
-      l1->repeated = 0;
+        // The repeated copy of a frame is what we'd see on the bus
+        // again, so that's the canonical form we look for and remember.
+        bool repeated = l1->repeated;
+        l1->repeated = 1;
+        CArray d1 = L_Data_to_CM_TP1 (l1);
+        l1->repeated = 0;
+        if (ignore.check (d1, repeated, getMonotonicTime ()))
+          {
+            TRACEPRINTF (t, 9, "Drop: %s", l1->Decode (t));
+            goto next;
+          }
+      }
 
       if (l1->address_type == IndividualAddress
           && l1->destination_address == this->addr)
         l1->destination_address = 0;
 
+      if (latency_stats && l1->ingress)
+        latency_dispatch[l1->ingress_link].add (getMonotonicTime () - l1->ingress);
+
       low_send_more = false;
       r_low->send_L_Data(std::move(l1));
 next:
@@ -1041,26 +1390,224 @@ next:
 
   if (!low_send_more)
     TRACEPRINTF (t, 6, "wait L");
+}
+
+std::string
+Router::latencyLinkName (int pos) const
+{
+  if (pos == -1)
+    return "clients";
+  auto i = links.find (pos);
+  if (i != links.end())
+    return i->second->name();
+  return "#" + std::to_string (pos);
+}
+
+void
+Router::busLoad (unsigned long& frames, size_t& queue) const
+{
+  frames = 0;
+  queue = 0;
+  for (auto i = links.cbegin(); i != links.cend(); i++)
+    {
+      const LinkConnect& l = *i->second;
+      if (l.transient || l.is_local)
+        continue;
+      frames += l.stats.rx_frames + l.stats.tx_frames;
+      if (queue < l.queue_length())
+        queue = l.queue_length();
+    }
+}
+
+unsigned long
+Router::queueDrops () const
+{
+  unsigned long res = 0;
+  for (auto i = links.cbegin(); i != links.cend(); i++)
+    res += i->second->queue_drops;
+  return res;
+}
+
+std::string
+Router::statsText (bool clients, bool latency) const
+{
+  std::string res;
+  char line[512];
+
+  snprintf (line, sizeof(line),
+            "router rx=%lu queue=%zu queue_max=%zu drop_no_dest=%lu drop_not_from_us=%lu"
+            " drop_hop_count=%lu drop_repeat=%lu drop_not_running=%lu\n",
+            stats.rx_frames, buf.size(), stats.queue_high, stats.drop_no_dest,
+            stats.drop_not_from_us, stats.drop_hop_count, ignore.hits,
+            stats.drop_not_running);
+  res += line;
+
+  std::vector<int> seqs;
+  seqs.reserve (links.size());
+  for (auto i = links.cbegin(); i != links.cend(); i++)
+    if (clients || !i->second->transient)
+      seqs.push_back (i->first);
+  std::sort (seqs.begin(), seqs.end());
+
+  for (auto i = seqs.cbegin(); i != seqs.cend(); i++)
+    {
+      LinkConnect& l = *links.at(*i);
+      const LinkStats& ls = l.stats;
+      snprintf (line, sizeof(line),
+                "link %s state=%s rx=%lu rx_bytes=%lu tx=%lu tx_bytes=%lu busmon=%lu"
+                " queue=%zu queue_max=%u drop_queue=%lu next_wait_avg=%lld next_wait_max=%lld"
+                " states=%lu errors=%lu\n",
+                l.name().c_str(), l.stateName(), ls.rx_frames, ls.rx_bytes,
+                ls.tx_frames, ls.tx_bytes, ls.rx_busmon, l.queue_length(),
+                l.queue_high, l.queue_drops,
+                ls.next_count ? ls.next_wait / ls.next_count : 0LL, ls.next_wait_max,
+                ls.state_changes, ls.errors);
+      res += line;
+    }
 
-  // Timestamps are ordered, so we scan for the first
-  timestamp_t tm = getTime ();
-  ITER (i, ignore)
-  if (i->end >= tm)
+  if (!latency)
+    return res;
+  std::vector<int> ins;
+  for (auto i = latency_dispatch.cbegin(); i != latency_dispatch.cend(); i++)
+    ins.push_back (i->first);
+  std::sort (ins.begin(), ins.end());
+  for (auto i = ins.cbegin(); i != ins.cend(); i++)
+    res += "latency dispatch from=" + latencyLinkName (*i) + " "
+           + latency_dispatch.at(*i).text() + "\n";
+
+  for (auto i = seqs.cbegin(); i != seqs.cend(); i++)
+    {
+      LinkConnect& l = *links.at(*i);
+      ins.clear();
+      for (auto j = l.latency.cbegin(); j != l.latency.cend(); j++)
+        ins.push_back (j->first);
+      std::sort (ins.begin(), ins.end());
+      for (auto j = ins.cbegin(); j != ins.cend(); j++)
+        {
+          const LinkLatency& ll = l.latency.at(*j);
+          std::string pair = "from=" + latencyLinkName (*j) + " to=" + l.name() + " ";
+          res += "latency send " + pair + ll.send.text() + "\n";
+          res += "latency done " + pair + ll.done.text() + "\n";
+        }
+    }
+  return res;
+}
+
+void
+Router::stats_timer_cb (ev::timer &, int)
+{
+  std::string tmp = stats_file + ".tmp";
+  FILE *f = fopen (tmp.c_str(), "w");
+  if (f == nullptr)
     {
-      ignore.erase (ignore.begin(), i);
-      break;
+      ERRORPRINTF (t, E_WARNING | 155, "stats file %s: %s", tmp, strerror(errno));
+      return;
+    }
+  std::string s = statsText (false, latency_stats);
+  bool ok = fwrite (s.data(), 1, s.size(), f) == s.size();
+  if (fclose (f) != 0)
+    ok = false;
+  if (!ok || rename (tmp.c_str(), stats_file.c_str()) != 0)
+    {
+      ERRORPRINTF (t, E_WARNING | 155, "stats file %s: %s", stats_file, strerror(errno));
+      unlink (tmp.c_str());
     }
 }
 
+void
+RepeatWindow::setup (timestamp_t window, unsigned int size)
+{
+  if (size < 1)
+    size = 1;
+  unsigned int nb = 1;
+  while (nb < size)
+    nb <<= 1;
+
+  this->window = window;
+  ring.clear();
+  ring.resize(size);
+  buckets.assign(nb, -1);
+  tail = 0;
+  used = 0;
+}
+
+uint32_t
+RepeatWindow::hashOf (const CArray& frame)
+{
+  // FNV-1a
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < frame.size(); i++)
+    {
+      h ^= frame[i];
+      h *= 16777619u;
+    }
+  return h;
+}
+
+void
+RepeatWindow::drop ()
+{
+  Entry& e = ring[tail];
+  int *p = &buckets[e.hash & (buckets.size()-1)];
+  while (*p != (int)tail)
+    p = &ring[*p].next;
+  *p = e.next;
+
+  tail = (tail + 1) % ring.size();
+  used--;
+}
+
+void
+RepeatWindow::expire (timestamp_t now)
+{
+  // entries are ordered by time, so stop at the first live one
+  while (used && ring[tail].end < now)
+    drop ();
+}
+
 bool
-Router::has_send_more(LinkConnectPtr i)
+RepeatWindow::check (const CArray& frame, bool repeated, timestamp_t now)
 {
-  if (i->send_more)
-    return true;
-  ERRORPRINTF (i->t, E_FATAL | 106, "internal error: send_more is not set");
+  expire (now);
+  uint32_t h = hashOf (frame);
+  if (repeated)
+    {
+      for (int i = buckets[h & (buckets.size()-1)]; i >= 0; i = ring[i].next)
+        {
+          const Entry& e = ring[i];
+          if (e.hash == h && e.data == frame)
+            {
+              hits++;
+              return true;
+            }
+        }
+      misses++;
+    }
+  add (frame, h, now);
   return false;
 }
 
+void
+RepeatWindow::add (const CArray& frame, uint32_t hash, timestamp_t now)
+{
+  if (used == ring.size())
+    {
+      evicted++;
+      drop ();
+    }
+
+  unsigned int pos = (tail + used) % ring.size();
+  Entry& e = ring[pos];
+  e.data = frame;
+  e.end = now + window;
+  e.hash = hash;
+
+  int& b = buckets[e.hash & (buckets.size()-1)];
+  e.next = b;
+  b = pos;
+  used++;
+}
+
 void
 Router::send_L_Data(LDataPtr l1)
 {
@@ -1068,27 +1615,25 @@ Router::send_L_Data(LDataPtr l1)
   high_sending = true;
   high_send_more = false;
 
+  // The frame is shared by all recipients from here on, so don't
+  // modify it. Its 'source' is never dereferenced by drivers.
   auto source = l1->source;
-  l1->source = nullptr;
 
   if (l1->address_type == GroupAddress)
     {
       // This is easy: send to all other L2 which subscribe to the
-      // group.
-      ITER(i, links)
-      {
-        auto ii = i->second;
-        if (ii->state != L_up)
-          continue;
-        if ((l1->source_address == 0xFFFF) // programming
-             ? &*ii == source
-             : ii->hasAddress(l1->source_address))
-          continue; // don't return to same interface
-        if(!has_send_more(ii))
-          continue; // internal error if not
-        if (ii->checkGroupAddress(l1->destination_address))
-          ii->send_L_Data (LDataPtr(new L_Data_PDU (*l1)));
-      }
+      // group. Don't use iterators here; the lists may grow while
+      // we're sending.
+      for (size_t i = 0; i < group_all.size(); i++)
+        sendGroup(group_all[i], l1, source, true);
+
+      auto gl = group_links.find(l1->destination_address);
+      if (gl != group_links.end())
+        {
+          std::vector<LinkConnect *>& v = gl->second;
+          for (size_t i = 0; i < v.size(); i++)
+            sendGroup(v[i], l1, source, false);
+        }
     }
   else if (l1->address_type == IndividualAddress)
     {
@@ -1098,35 +1643,72 @@ Router::send_L_Data(LDataPtr l1)
       // Address ~0 is special; it's used for programming
       // so can be on different interfaces. Always broadcast these.
       bool found = (l1->destination_address == this->addr);
+      LinkConnect *dl = nullptr;
       if (l1->destination_address != 0xFFFF)
-        ITER(i, links)
         {
-          auto ii = i->second;
-          if (ii->hasAddress (l1->source_address))
-            continue;
-          if (ii->hasAddress (l1->destination_address))
+          dl = addr_links[l1->destination_address];
+          // skip a stale entry
+          if (dl != nullptr && (fromLink(dl, l1->source_address, source)
+                                || !linkHasAddress(dl, l1->destination_address)))
+            dl = nullptr;
+          if (dl != nullptr)
+            found = true;
+          else
+            // Not indexed (yet). Ask the links: filters, for instance,
+            // may answer for a whole range of addresses.
+            ITER(i, links)
             {
-              found = true;
-              break;
+              auto ii = i->second;
+              if (fromLink(&*ii, l1->source_address, source))
+                continue;
+              if (linkHasAddress(&*ii, l1->destination_address))
+                {
+                  found = true;
+                  break;
+                }
             }
         }
-      ITER (i, links)
-      {
-        auto ii = i->second;
-        if (ii->state != L_up)
-          continue;
-        if (ii->hasAddress (l1->source_address))
-          continue; // don't return to same interface
-        if(!has_send_more(ii))
-          continue; // internal error if not
-        if (l1->hop_count == 7 || found ? ii->hasAddress (l1->destination_address) : ii->checkAddress (l1->destination_address))
-          i->second->send_L_Data (LDataPtr(new L_Data_PDU (*l1)));
-      }
+      if (dl != nullptr)
+        {
+          if (dl->state == L_up)
+            dl->send_L_Data (l1);
+        }
+      else
+        ITER (i, links)
+        {
+          auto ii = i->second;
+          if (ii->state != L_up)
+            continue;
+          if (fromLink(&*ii, l1->source_address, source))
+            continue; // don't return to same interface
+          if (l1->hop_count == 7 || found
+              ? linkHasAddress(&*ii, l1->destination_address)
+              : ii->checkAddress (l1->destination_address))
+            ii->send_L_Data (l1);
+        }
     }
   high_sending = false;
+  if (groups_dirty)
+    compactGroups();
   send_Next(); // check readiness
 }
 
+void
+Router::sendGroup (LinkConnect *ii, const LDataPtr& l1, void *source, bool check)
+{
+  if (ii == nullptr || ii->state != L_up)
+    return;
+  if ((l1->source_address == 0xFFFF) // programming
+      ? ii == source
+      : fromLink(ii, l1->source_address, source))
+    return; // don't return to same interface
+  // A subscriber wants the group address, but a filter on its stack
+  // may still reject it.
+  if ((check || ii->hasFilters()) && !ii->checkGroupAddress(l1->destination_address))
+    return;
+  ii->send_L_Data (l1);
+}
+
 void
 Router::mtrigger_cb (ev::async &, int)
 {
@@ -1136,7 +1718,7 @@ Router::mtrigger_cb (ev::async &, int)
 
       TRACEPRINTF (t, 3, "RecvMon %s", l1->Decode (t));
       ITER (i, busmonitor)
-      i->cb->send_L_Busmonitor (LBusmonPtr(new L_Busmon_PDU (*l1)));
+      i->cb->send_L_Busmonitor (l1);
     }
 }
 
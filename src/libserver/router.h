@@ -32,8 +32,10 @@
 #include <ev++.h>
 
 #include "link.h"
+#include "linkthread.h"
 #include "lowlevel.h"
 #include "lpdu.h"
+#include "prioqueue.h"
 
 class BaseServer;
 class GroupCache;
@@ -55,10 +57,63 @@ struct Busmonitor_Info
   L_Busmonitor_CallBack *cb;
 };
 
-struct IgnoreInfo
+/** Remembers recently forwarded frames so that repeated copies of them
+ * can be dropped. Fixed capacity; entries are kept in arrival order in a
+ * ring and additionally chained into hash buckets for lookup. */
+class RepeatWindow
 {
-  CArray data;
-  timestamp_t end;
+public:
+  /** @param window how long to remember a frame, in µs
+   *  @param size maximum number of remembered frames */
+  void setup (timestamp_t window, unsigned int size);
+
+  /** Check whether a repeated frame has been seen within the window;
+   * if not, remember it.
+   * @param frame canonical (repeat flag set) frame bytes
+   * @param repeated whether the frame has the repeat flag set
+   * @return true if the frame is to be dropped */
+  bool check (const CArray& frame, bool repeated, timestamp_t now);
+
+  /** repeated frames which were dropped */
+  unsigned long hits = 0;
+  /** repeated frames which were not found, thus forwarded */
+  unsigned long misses = 0;
+  /** entries discarded before their time because the ring was full */
+  unsigned long evicted = 0;
+
+private:
+  struct Entry
+  {
+    CArray data;
+    timestamp_t end;
+    uint32_t hash;
+    int next; // next entry in the same bucket, or -1
+  };
+  std::vector<Entry> ring;
+  std::vector<int> buckets;
+  /** oldest live entry */
+  unsigned int tail = 0;
+  unsigned int used = 0;
+  timestamp_t window = 1000000;
+
+  static uint32_t hashOf (const CArray& frame);
+  void expire (timestamp_t now);
+  void drop ();
+  void add (const CArray& frame, uint32_t hash, timestamp_t now);
+};
+
+/** Runtime counters of the router. See Router::statsText(). */
+struct RouterStats
+{
+  /** frames accepted from the links */
+  unsigned long rx_frames = 0;
+  /** longest the ingress queue has been */
+  size_t queue_high = 0;
+  /** frames dropped, by reason. Repeats are counted by the RepeatWindow. */
+  unsigned long drop_no_dest = 0;
+  unsigned long drop_not_from_us = 0;
+  unsigned long drop_hop_count = 0;
+  unsigned long drop_not_running = 0;
 };
 
 class Router : public BaseRouter
@@ -88,6 +143,10 @@ public:
 
   /** read and apply settings */
   bool setup();
+  /** Apply a re-read config file: links which have been added or
+   * changed are (re)started, removed ones are stopped. Everything else,
+   * including the group cache and client connections, is kept. */
+  bool reload(IniData& nd);
   /** start up */
   void start();
   /** shut down*/
@@ -126,6 +185,15 @@ public:
 
   /** check if any interface knows this address. */
   bool hasAddress (eibaddr_t addr, LinkConnectPtr& link, bool quiet = false) const;
+  /** remember that this address has been seen on this link */
+  void addAddress (eibaddr_t addr, LinkConnect& link);
+  /** forget that this address is on this link */
+  void dropAddress (eibaddr_t addr, LinkConnect& link);
+
+  /** add/remove a link's group subscription to/from the index */
+  void indexGroups (LinkConnect& link, bool on);
+  /** add/remove a single group address of a link to/from the index */
+  void indexGroup (LinkConnect& link, eibaddr_t ga, bool on);
   /** check if any interface accepts this address.
       'l2' says which interface NOT to check. */
   bool checkAddress (eibaddr_t addr, LinkConnectPtr l2 = nullptr) const;
@@ -169,6 +237,31 @@ public:
   {
     return all_running;
   }
+  /** repeat suppression statistics */
+  const RepeatWindow& repeatWindow() const
+  {
+    return ignore;
+  }
+
+  RouterStats stats;
+  /** The router's and the links' counters, one line each.
+   * Clients' links are only included if @clients is set; the latency
+   * histograms if @latency is. */
+  std::string statsText(bool clients = false, bool latency = false) const;
+  /** For pacing background traffic: the frames sent and received by the
+   * links to a bus (i.e. not the clients), summed up, and the longest
+   * send queue among these links. */
+  void busLoad (unsigned long& frames, size_t& queue) const;
+  /** frames dropped because a link's send queue was full, all links */
+  unsigned long queueDrops () const;
+  /** how statsText() names a latency histogram's ingress link */
+  std::string latencyLinkName (int pos) const;
+
+  /** Record latency histograms? See LinkLatency. */
+  bool latency_stats = false;
+  /** time from arrival until a frame leaves the router's queue,
+   * by L_Data_PDU::ingress_link */
+  std::unordered_map<int, LatencyHistogram> latency_dispatch;
 
 private:
   Factory<Server>& servers;
@@ -195,9 +288,45 @@ private:
 
   /** create a link */
   LinkConnectPtr setup_link(std::string& name);
+  /** the link names in this section's "connections" */
+  std::vector<std::string> connectionList(IniSectionPtr& s);
+
+  /** worker loops for threaded links, by name.
+   * Declared before the links so that it outlives their driver stacks. */
+  std::unordered_map<std::string, WorkerLoopPtr> workers;
+  WorkerLoopPtr get_worker(const std::string& name);
 
   /** interfaces */
   std::unordered_map<int, LinkConnectPtr> links;
+  /** unregistered by reload(), kept until they are down */
+  std::vector<LinkConnectPtr> retired;
+
+  /** individual address => the registered link it has been seen on */
+  std::vector<LinkConnect *> addr_links;
+  /** forget the addresses of this (unregistered) link */
+  void dropAddresses (LinkConnect& link);
+  /** is this link in our list? */
+  bool isRegistered (const LinkConnect& link) const;
+
+  /** links which want to see every group address */
+  std::vector<LinkConnect *> group_all;
+  /** group address => links which subscribed to it */
+  std::unordered_map<eibaddr_t, std::vector<LinkConnect *> > group_links;
+  /** group index entries have been cleared while sending */
+  bool groups_dirty = false;
+  void unlistGroupLink (std::vector<LinkConnect *>& v, LinkConnect *link);
+  void compactGroups ();
+  void sendGroup (LinkConnect *link, const LDataPtr& l1, void *source, bool check);
+  /** check whether this link has been assigned, or knows, this address */
+  bool linkHasAddress (const LinkConnect *link, eibaddr_t addr) const
+  {
+    return link->addr == addr || link->hasAddress(addr);
+  }
+  /** check whether this packet arrived via this link */
+  bool fromLink (const LinkConnect *link, eibaddr_t src, void *source) const
+  {
+    return link == source || addr_links[src] == link;
+  }
 
   /** queue of interfaces which called linkChanged() */
   Queue<LinkConnectPtr> linkChanges;
@@ -209,19 +338,27 @@ private:
   void mtrigger_cb (ev::async &w, int revents);
   ev::async state_trigger;
   void state_trigger_cb (ev::async &w, int revents);
+  /** periodically write statsText() to this file */
+  std::string stats_file;
+  ev::timer stats_timer;
+  void stats_timer_cb (ev::timer &w, int revents);
 
   /** buffer queues for receiving from L2 */
-  Queue < LDataPtr > buf;
+  LDataQueue buf;
   Queue < LBusmonPtr > mbuf;
-  /** buffer for packets to ignore when repeat flag is set */
-  std::vector < IgnoreInfo > ignore;
+  /** packets to ignore when repeat flag is set */
+  RepeatWindow ignore;
 
   /** Start of address block to assign dynamically to clients */
   eibaddr_t client_addrs_start;
   /** Length of address block to assign dynamically to clients */
   int client_addrs_len = 0;
+  /** the most recently assigned position */
   int client_addrs_pos;
-  std::vector<bool> client_addrs;
+  /** bitmap of unassigned positions, 64 per word; bit set = free */
+  std::vector<uint64_t> client_addrs_free;
+  /** first free position in [from,to), or -1 */
+  int nextFreeClientAddr (int from, int to) const;
 
   /** busmonitor callbacks */
   std::vector < Busmonitor_Info > busmonitor;
@@ -256,9 +393,6 @@ private:
   /** parser support */
   bool readaddr (const std::string& addr, eibaddr_t& parsed);
   bool readaddrblock (const std::string& addr, eibaddr_t& parsed, int &len);
-
-  /** error checking */
-  bool has_send_more(LinkConnectPtr i);
 };
 
 #endif
@@ -44,7 +44,7 @@ SystemdServer::start()
       return;
     }
 
-  if (listen (fd, 10) == -1)
+  if (listen (fd, SOMAXCONN) == -1)
     {
       ERRORPRINTF (t, E_ERROR | 98, "OpenSystemdSocket: listen: %s", strerror(errno));
       NetServer::stop(true);
@@ -27,6 +27,7 @@ static bool trace_started = false;
 
 unsigned int trace_seq = 0;
 unsigned int trace_namelen = 3;
+std::mutex trace_lock;
 
 std::string Trace::fullname() const
 {
@@ -67,6 +68,7 @@ Trace::TracePacketUncond (const int layer, const char *msg, const int Len,
                           const uint8_t * data)
 {
   int i;
+  std::lock_guard<std::mutex> g (trace_lock);
   TraceHeader(layer);
   fmt::printf ("%s(%03d):", msg, Len);
   for (i = 0; i < Len; i++)
@@ -35,6 +35,7 @@
 #include <fmt/printf.h>
 #endif
 #include <iostream>
+#include <mutex>
 #include <sys/time.h>
 
 #include "common.h"
@@ -63,6 +64,8 @@ constexpr unsigned int E_INFO = LEVEL_INFO<<28;
 
 extern unsigned int trace_seq;
 extern unsigned int trace_namelen;
+/** keeps the lines of threaded links' messages apart */
+extern std::mutex trace_lock;
 
 /** implements debug output with different levels */
 class Trace
@@ -179,6 +182,7 @@ public:
   template <typename... Args>
   void TracePrintf (const int layer, const char *msg, const Args & ... args)
   {
+    std::lock_guard<std::mutex> g (trace_lock);
     TraceHeader(layer);
     fmt::fprintf(stdout, msg, args ...);
     fmt::printf ("\n");
@@ -192,6 +196,7 @@ public:
   template <typename... Args>
   void ErrorPrintfUncond (const unsigned int msgid, const char *msg, const Args & ... args)
   {
+    std::lock_guard<std::mutex> g (trace_lock);
     char c = get_level_char((msgid >> 28) & 0x0f);
     if (servername.length())
       fmt::fprintf(stderr, "%s: ",servername.c_str());
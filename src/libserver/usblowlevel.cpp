@@ -156,7 +156,9 @@ USBLowLevelDriver::USBLowLevelDriver (LowLevelIface* p, IniSectionPtr& s) : LowL
   t->setAuxName("usbL");
   send_timeout = cfg->value("send-timeout", 1000);
   loop = nullptr;
+  read_trigger.set (evloop);
   read_trigger.set<USBLowLevelDriver,&USBLowLevelDriver::read_trigger_cb>(this);
+  write_trigger.set (evloop);
   write_trigger.set<USBLowLevelDriver,&USBLowLevelDriver::write_trigger_cb>(this);
   read_trigger.start();
   write_trigger.start();
@@ -186,7 +188,7 @@ USBLowLevelDriver::start()
       goto ex;
     }
 
-  loop = new USBLoop (t);
+  loop = new USBLoop (evloop, t);
 
   if (!loop->context)
     {
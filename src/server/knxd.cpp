@@ -25,6 +25,7 @@
 #include <signal.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
 #include <ev++.h>
 #include "router.h"
@@ -103,6 +104,37 @@ die (const char *msg, ...)
   exit (1);
 }
 
+/** map the ev-backend option to libev's flag, or ~0 if unknown */
+static unsigned int
+ev_backend (const std::string& name)
+{
+  if (name == "")
+#ifdef __linux__
+    return EVBACKEND_EPOLL;
+#else
+    return 0; // let libev decide
+#endif
+  if (name == "auto")
+    return 0;
+  if (name == "select")
+    return EVBACKEND_SELECT;
+  if (name == "poll")
+    return EVBACKEND_POLL;
+  if (name == "epoll")
+    return EVBACKEND_EPOLL;
+#if EV_VERSION_MAJOR > 4 || (EV_VERSION_MAJOR == 4 && EV_VERSION_MINOR >= 31)
+  if (name == "linuxaio")
+    return EVBACKEND_LINUXAIO;
+  if (name == "io_uring")
+    return EVBACKEND_IOURING;
+#endif
+  if (name == "kqueue")
+    return EVBACKEND_KQUEUE;
+  if (name == "port")
+    return EVBACKEND_PORT;
+  return ~0U;
+}
+
 /** version */
 //const char *argp_program_version = "knxd " REAL_VERSION;
 /** documentation */
@@ -242,6 +274,7 @@ struct _hup
   struct ev_signal sighup;
   const char *logfile;
   TracePtr t;
+  Router *r;
 } hup;
 
 static void
@@ -253,15 +286,30 @@ sighup_cb (EV_P_ ev_signal *w, int)
     {
       int fd = open (hup->logfile, O_WRONLY | O_APPEND | O_CREAT, 0660);
       if (fd == -1)
+        ERRORPRINTF (hup->t, E_ERROR | 21, "can't open log file %s", hup->logfile);
+      else
         {
-          ERRORPRINTF (hup->t, E_ERROR | 21, "can't open log file %s", hup->logfile);
-          return;
+          dup2 (fd, 1);
+          dup2 (fd, 2);
+          if (fd > 2)
+            close (fd);
         }
-      dup2 (fd, 1);
-      dup2 (fd, 2);
-      if (fd > 2)
-        close (fd);
     }
+
+  if (!strcmp(cfgfile, "-"))
+    {
+      ERRORPRINTF (hup->t, E_WARNING | 166, "The configuration was read from stdin, can't reload it.");
+      return;
+    }
+  IniData nd;
+  int errl = nd.parse(cfgfile);
+  if (errl)
+    {
+      ERRORPRINTF (hup->t, E_ERROR | 166, "Parse error of '%s' in line %d, not reloaded.", cfgfile, errl);
+      return;
+    }
+  if (!hup->r->reload(nd))
+    ERRORPRINTF (hup->t, E_ERROR | 167, "Not all links of '%s' could be set up.", cfgfile);
 }
 
 int
@@ -273,10 +321,6 @@ main (int ac, char *ag[])
   argv = ag;
   argc = ac;
 
-// set up libev
-  loop = ev_default_loop(EVFLAG_AUTO | EVFLAG_NOSIGMASK | EVBACKEND_SELECT);
-  assert (loop);
-
 #ifdef EV_TRACE
   struct ev_timer timer;
 #endif
@@ -294,11 +338,6 @@ main (int ac, char *ag[])
   if( num_fds < 0 )
     die("Error getting sockets from systemd.");
 #endif
-#ifdef EV_TRACE
-  ev_timer_init (&timer, timeout_cb, 1., 10.);
-  ev_timer_again (EV_A_ &timer);
-#endif
-
   std::string arg_str = "";
   for (index=0; index<ac; index++)
     {
@@ -380,6 +419,35 @@ x1:
   if (!stop_now)
     stop_now = main->value("stop-after-setup",false);
 
+  {
+    // set up libev
+    std::string bn = main->value("ev-backend","");
+    unsigned int backend = ev_backend (bn);
+    if (backend == ~0U)
+      die ("Unknown ev-backend '%s'", bn.c_str());
+    if (backend && !(ev_supported_backends () & backend))
+      {
+        if (bn.size())
+          die ("ev-backend '%s' is not supported on this system", bn.c_str());
+        backend = 0;
+      }
+    loop = ev_default_loop(EVFLAG_AUTO | EVFLAG_NOSIGMASK | backend);
+    if (!loop)
+      die ("Could not initialize libev");
+
+    // lots of clients need lots of file descriptors
+    struct rlimit rl;
+    if (getrlimit (RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max)
+      {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit (RLIMIT_NOFILE, &rl);
+      }
+  }
+#ifdef EV_TRACE
+  ev_timer_init (&timer, timeout_cb, 1., 10.);
+  ev_timer_again (EV_A_ &timer);
+#endif
+
   {
     // handle stdin/out/err
     int fd = open("/dev/null", O_RDONLY);
@@ -423,14 +491,12 @@ x1:
   if (!strcmp(cfgfile, "-"))
     ERRORPRINTF(r->t, E_WARNING | 125,"Consider using a config file.");
 
-  if (background)
-    {
-      hup.t = TracePtr(new Trace(*r->t));
-      hup.t->setAuxName("reload");
-      hup.logfile = logfile;
-      ev_signal_init (&hup.sighup, sighup_cb, SIGHUP);
-      ev_signal_start (EV_A_ &hup.sighup);
-    }
+  hup.t = TracePtr(new Trace(*r->t));
+  hup.t->setAuxName("reload");
+  hup.logfile = logfile;
+  hup.r = r;
+  ev_signal_init (&hup.sighup, sighup_cb, SIGHUP);
+  ev_signal_start (EV_A_ &hup.sighup);
 
   signal (SIGPIPE, SIG_IGN);
 
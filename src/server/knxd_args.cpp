@@ -290,6 +290,12 @@ void driver_args(const char *arg, char *ap)
     }
   else if(!strcmp(arg,"dummy"))
     driver_argsv(arg,ap, NULL);
+  else if(!strcmp(arg,"loadgen"))
+    driver_argsv(arg,ap, "rate","count", NULL);
+  else if(!strcmp(arg,"sink"))
+    driver_argsv(arg,ap, "service-time", NULL);
+  else if(!strcmp(arg,"replay"))
+    driver_argsv(arg,ap, "!file","speed", NULL);
   else
     die ("I don't know of options for %s",arg);
 }
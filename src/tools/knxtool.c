@@ -82,7 +82,7 @@ msetkey grouplisten groupresponse groupsresponse groupsocketlisten groupsocketre
 vbusmonitor1poll groupreadresponse groupcacheenable groupcachedisable groupcacheclear groupcacheremove \n\
 groupcachereadsync groupcacheread mwriteplain mrestart groupsocketwrite groupsocketswrite \n\
 xpropread xpropwrite groupcachelastupdates busmonitor3 vbusmonitor3 eibread-cgi eibwrite-cgi \n\
-vbusmonitor1time\n");
+vbusmonitor1time stats groupcachereadbulk\n");
       return 0;
     }
 
@@ -528,6 +528,31 @@ vbusmonitor1time\n");
         }
       printf ("\n");
     }
+  else if (strcmp (prog, "stats") == 0)
+    {
+      uint8_t *sbuf;
+      int flags = 0, i;
+
+      if (ac < 2 || ac > 4)
+        die ("usage: %s url [clients] [latency]", prog);
+      for (i = 2; i < ac; i++)
+        if (!strcmp (ag[i], "clients"))
+          flags |= 1;
+        else if (!strcmp (ag[i], "latency"))
+          flags |= 2;
+        else
+          die ("usage: %s url [clients] [latency]", prog);
+      con = open_con(ag[1]);
+
+      sbuf = (uint8_t *) malloc (65536);
+      if (!sbuf)
+        die ("out of memory");
+      len = EIB_Stats (con, flags, 65536, sbuf);
+      if (len == -1)
+        die ("Read failed");
+      fwrite (sbuf, 1, len, stdout);
+      free (sbuf);
+    }
   else if (strcmp (prog, "groupcacheread") == 0)
     {
       if (ac != 3)
@@ -560,6 +585,84 @@ vbusmonitor1time\n");
         }
       printf ("\n");
     }
+  else if (strcmp (prog, "groupcachereadbulk") == 0)
+    {
+      uint8_t *ranges, *rbuf;
+      uint16_t age;
+      eibaddr_t next = 0;
+      int i, max = 65535;
+      const char *sep;
+
+      if (ac < 3)
+        die ("usage: %s url age[:maxlen] [groupaddr[-groupaddr] ...]", prog);
+      con = open_con(ag[1]);
+      age = atoi (ag[2]);
+      sep = strchr (ag[2], ':');
+      if (sep)
+        max = atoi (sep + 1);
+      if (max < 1 || max > 65535)
+        die ("maxlen must be 1..65535");
+
+      ranges = (uint8_t *) malloc (4 * (ac - 3) + 1);
+      rbuf = (uint8_t *) malloc (max);
+      if (!ranges || !rbuf)
+        die ("out of memory");
+      for (i = 3; i < ac; i++)
+        {
+          eibaddr_t first = readgaddr (ag[i]);
+          eibaddr_t last;
+
+          sep = strchr (ag[i], '-');
+          last = sep ? readgaddr (sep + 1) : first;
+
+          ranges[4 * (i - 3)] = first >> 8;
+          ranges[4 * (i - 3) + 1] = first & 0xff;
+          ranges[4 * (i - 3) + 2] = last >> 8;
+          ranges[4 * (i - 3) + 3] = last & 0xff;
+        }
+
+      do
+        {
+          len = EIB_Cache_ReadBulk (con, next, age, 4 * (ac - 3), ranges,
+                                    max, rbuf, &next);
+          if (len == -1)
+            die ("Read failed");
+
+          for (i = 0; i + 7 <= len; i += 7 + rbuf[i + 6])
+            {
+              uint8_t *e = rbuf + i;
+              int alen = e[6];
+
+              if (i + 7 + alen > len)
+                die ("Invalid reply");
+              printGroup ((e[2] << 8) | e[3]);
+              switch (alen > 1 ? e[8] & 0xC0 : 0)
+                {
+                case 0x40:
+                  printf (" Response");
+                  break;
+                case 0x80:
+                  printf (" Write");
+                  break;
+                }
+              printf (" from ");
+              printIndividual ((e[0] << 8) | e[1]);
+              printf (", %ds ago", (e[4] << 8) | e[5]);
+              if (alen > 1 && (e[8] & 0xC0))
+                {
+                  printf (": ");
+                  if (alen == 2)
+                    printf ("%02X", e[8] & 0x3F);
+                  else
+                    printHex (alen - 2, e + 9);
+                }
+              printf ("\n");
+            }
+        }
+      while (next);
+      free (rbuf);
+      free (ranges);
+    }
   else if (strcmp (prog, "groupcachereadsync") == 0)
     {
       uint16_t age = 0;
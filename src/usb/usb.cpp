@@ -35,9 +35,10 @@ static void pollfd_removed_cb (int, void *user_data)
   loop->setup();
 }
 
-USBLoop::USBLoop (TracePtr tr)
+USBLoop::USBLoop (struct ev_loop *loop, TracePtr tr)
 {
   t = tr;
+  evloop = loop;
   if (libusb_init (&context))
     {
       ERRORPRINTF (t, E_ERROR | 40, "USBLoop-Create: %s", strerror(errno));
@@ -57,6 +58,7 @@ USBLoop::USBLoop (TracePtr tr)
     libusb_set_debug(context,LIBUSB_LOG_LEVEL_ERROR);
 #endif
 
+  tm.set (loop);
   tm.set<USBLoop, &USBLoop::timer_cb>(this);
   libusb_set_pollfd_notifiers (context, pollfd_added_cb,pollfd_removed_cb, this);
   setup();
@@ -84,7 +86,7 @@ void USBLoop::setup()
     {
       if (it->events & POLLIN)
         {
-          ev::io *io = new ev::io();
+          ev::io *io = new ev::io(evloop);
           io->set<USBLoop, &USBLoop::io_cb>(this);
           io->start(it->fd,ev::READ);
           fds.push_back(io);
@@ -92,7 +94,7 @@ void USBLoop::setup()
         }
       if (it->events & POLLOUT)
         {
-          ev::io *io = new ev::io();
+          ev::io *io = new ev::io(evloop);
           io->set<USBLoop, &USBLoop::io_cb>(this);
           io->start(it->fd,ev::WRITE);
           fds.push_back(io);
@@ -28,6 +28,7 @@
 class USBLoop
 {
   TracePtr t;
+  struct ev_loop *evloop;
 
   std::vector < ev::io * > fds;
   ev::timer tm;
@@ -39,7 +40,7 @@ class USBLoop
 public:
   libusb_context *context;
 
-  USBLoop (TracePtr tr);
+  USBLoop (struct ev_loop *loop, TracePtr tr);
   virtual ~USBLoop ();
 
   void setup();
@@ -0,0 +1,199 @@
+/*
+    EIBD eib bus access and management daemon
+    Copyright (C) 2005-2011 Martin Koegler <mkoegler@auto.tuwien.ac.at>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+/*
+ * Connection storm benchmark: open lots of client connections to a
+ * running knxd at once, the way visualizations do after a network
+ * hiccup. Every connection is assigned a client address.
+ *
+ *   knxd -e 1.0.1 -E 2.0.1:2000 -u /tmp/knx -i -b dummy: &
+ *   tools/bench_clients /tmp/knx 1000 5
+ *   tools/bench_clients local:/tmp/knx,ip:localhost 1000 1
+ *
+ * Like knxtool, a socket is "local:PATH" or "ip:HOST[:PORT]"; a plain
+ * path is a Unix socket. With several sockets, each gets that many
+ * clients, and all of them are connected at the same time.
+ *
+ * The knxd needs at least as many client addresses as connections.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <netdb.h>
+#include <signal.h>
+
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "eibtypes.h"
+
+struct Target
+{
+  std::string url;
+  struct sockaddr_storage addr;
+  socklen_t len;
+};
+
+static bool
+resolve (const std::string& url, Target& t)
+{
+  t.url = url;
+  memset (&t.addr, 0, sizeof(t.addr));
+  if (url.compare (0, 3, "ip:"))
+    {
+      std::string path = url.compare (0, 6, "local:") ? url : url.substr (6);
+      struct sockaddr_un *a = (struct sockaddr_un *) &t.addr;
+      a->sun_family = AF_UNIX;
+      strncpy (a->sun_path, path.c_str(), sizeof(a->sun_path) - 1);
+      t.len = sizeof(*a);
+      return true;
+    }
+
+  std::string host = url.substr (3), port = "6720";
+  size_t colon = host.find (':');
+  if (colon != std::string::npos)
+    {
+      port = host.substr (colon + 1);
+      host.erase (colon);
+    }
+  struct addrinfo hints, *res;
+  memset (&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  if (getaddrinfo (host.c_str(), port.c_str(), &hints, &res))
+    return false;
+  memcpy (&t.addr, res->ai_addr, res->ai_addrlen);
+  t.len = res->ai_addrlen;
+  freeaddrinfo (res);
+  return true;
+}
+
+static int
+do_connect (const Target& t)
+{
+  int fd = socket (t.addr.ss_family, SOCK_STREAM, 0);
+  if (fd < 0)
+    return -1;
+  if (connect (fd, (const struct sockaddr *) &t.addr, t.len) < 0)
+    {
+      close (fd);
+      return -1;
+    }
+  return fd;
+}
+
+/* A round trip makes sure that knxd has set up the connection. */
+static bool
+ping (int fd)
+{
+  unsigned char buf[4] = { 0, 2, 0, EIB_RESET_CONNECTION };
+  if (write (fd, buf, 4) != 4)
+    return false;
+  size_t got = 0;
+  while (got < 4)
+    {
+      ssize_t n = read (fd, buf + got, 4 - got);
+      if (n <= 0)
+        return false;
+      got += n;
+    }
+  return buf[3] == EIB_RESET_CONNECTION;
+}
+
+int
+main (int argc, const char *argv[])
+{
+  if (argc < 2)
+    {
+      std::cerr << "Usage: " << argv[0] << " socket[,socket...] [clients [rounds]]" << std::endl;
+      exit(1);
+    }
+  std::vector<Target> targets;
+  std::string urls = argv[1];
+  for (size_t pos = 0; pos <= urls.size(); )
+    {
+      size_t end = urls.find (',', pos);
+      if (end == std::string::npos)
+        end = urls.size();
+      Target t;
+      if (!resolve (urls.substr (pos, end - pos), t))
+        {
+          std::cerr << "Cannot resolve " << urls.substr (pos, end - pos) << std::endl;
+          exit(1);
+        }
+      targets.push_back (t);
+      pos = end + 1;
+    }
+  int n = argc > 2 ? atoi (argv[2]) : 1000;
+  int rounds = argc > 3 ? atoi (argv[3]) : 5;
+
+  signal (SIGPIPE, SIG_IGN);
+
+  struct rlimit rl;
+  if (getrlimit (RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max)
+    {
+      rl.rlim_cur = rl.rlim_max;
+      setrlimit (RLIMIT_NOFILE, &rl);
+    }
+
+  std::vector<int> fds;
+  fds.reserve (n * targets.size());
+  for (int r = 0; r < rounds; r++)
+    {
+      auto t0 = std::chrono::steady_clock::now ();
+      for (const Target& t : targets)
+        for (int i = 0; i < n; i++)
+          {
+            int fd = do_connect (t);
+            if (fd < 0)
+              {
+                perror (t.url.c_str());
+                exit(2);
+              }
+            fds.push_back (fd);
+          }
+      for (int fd : fds)
+        if (!ping (fd))
+          {
+            std::cerr << "no reply from knxd (out of client addresses?)" << std::endl;
+            exit(2);
+          }
+      auto t1 = std::chrono::steady_clock::now ();
+      double ms = std::chrono::duration<double, std::milli> (t1 - t0).count ();
+      size_t total = fds.size ();
+      for (int fd : fds)
+        close (fd);
+      fds.clear ();
+
+      printf ("round %d: %zu clients in %.1f ms, %.1f µs per client\n",
+              r + 1, total, ms, ms * 1000 / total);
+
+      // let knxd notice the closed connections before the next storm
+      usleep (200000);
+    }
+  return 0;
+}
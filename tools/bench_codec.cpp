@@ -0,0 +1,362 @@
+/*
+    EIBD eib bus access and management daemon
+    Copyright (C) 2005-2011 Martin Koegler <mkoegler@auto.tuwien.ac.at>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+/*
+ * Microbenchmark of the frame encoders and decoders: time and heap
+ * allocations per frame.
+ *
+ *   tools/bench_codec [-n ROUNDS] [corpus]
+ *
+ * The corpus is a text file with one TP1 frame per line, as hex bytes
+ * (spaces are ignored, '#' starts a comment). Without one, a built-in
+ * mix resembling the traffic of a typical installation is used.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <netinet/in.h>
+
+#include "apdu.h"
+#include "cm_tp1.h"
+#include "eibnetip.h"
+#include "emi.h"
+#include "tpdu.h"
+
+/* count heap allocations: operator new, and the malloc / realloc calls
+ * of CArray and the frame pools. Without glibc, only operator new. */
+
+static unsigned long n_allocs = 0;
+
+#ifdef __GLIBC__
+extern "C" void *__libc_malloc (size_t sz);
+extern "C" void *__libc_calloc (size_t n, size_t sz);
+extern "C" void *__libc_realloc (void *p, size_t sz);
+
+extern "C" void *
+malloc (size_t sz)
+{
+  n_allocs++;
+  return __libc_malloc (sz);
+}
+
+extern "C" void *
+calloc (size_t n, size_t sz)
+{
+  n_allocs++;
+  return __libc_calloc (n, sz);
+}
+
+extern "C" void *
+realloc (void *p, size_t sz)
+{
+  n_allocs++;
+  return __libc_realloc (p, sz);
+}
+#endif
+
+void *
+operator new (size_t sz)
+{
+#ifndef __GLIBC__
+  n_allocs++;
+#endif
+  void *p = malloc (sz ? sz : 1);
+  if (!p)
+    throw std::bad_alloc ();
+  return p;
+}
+
+void
+operator delete (void *p) noexcept
+{
+  free (p);
+}
+
+void
+operator delete (void *p, size_t) noexcept
+{
+  free (p);
+}
+
+/* the built-in corpus */
+
+struct Sample
+{
+  /** how often this kind of frame appears, relatively */
+  int weight;
+  bool group;
+  const char *src, *dst;
+  EIB_Priority prio;
+  /** TPDU, hex */
+  const char *lsdu;
+};
+
+static const Sample builtin[] = {
+  // switching, dimming, blinds: 1 bit / 4 bit
+  { 30, true, "1.1.10", "1/0/1", PRIO_LOW, "0081" },
+  { 20, true, "1.1.11", "1/1/7", PRIO_LOW, "0080" },
+  { 5, true, "1.1.12", "1/2/3", PRIO_LOW, "0089" },
+  // status feedback
+  { 15, true, "1.1.10", "1/0/2", PRIO_LOW, "0041" },
+  // DPT 5: percentage
+  { 8, true, "1.2.4", "2/1/10", PRIO_LOW, "0080c0" },
+  // DPT 9: temperature, humidity
+  { 25, true, "1.3.1", "3/0/1", PRIO_LOW, "00800c65" },
+  { 10, true, "1.3.2", "3/0/2", PRIO_LOW, "00801a3c" },
+  // DPT 14: power, energy
+  { 6, true, "1.4.1", "4/0/1", PRIO_LOW, "008042f6e979" },
+  // DPT 10/11: time and date broadcast
+  { 1, true, "1.0.1", "0/0/1", PRIO_LOW, "0080351e00" },
+  { 1, true, "1.0.1", "0/0/2", PRIO_LOW, "0080120a18" },
+  // DPT 16: text
+  { 2, true, "1.5.1", "5/0/1", PRIO_LOW, "00804b4e5844206973207275 6e6e696e67" },
+  // visualization polling
+  { 6, true, "0.0.2", "1/0/2", PRIO_LOW, "0000" },
+  // alarms
+  { 1, true, "1.6.1", "6/0/1", PRIO_SYSTEM, "0081" },
+  // management: connect, device descriptor, property read, memory read, ack, disconnect
+  { 1, false, "0.0.2", "1.1.10", PRIO_SYSTEM, "80" },
+  { 1, false, "0.0.2", "1.1.10", PRIO_LOW, "4300" },
+  { 1, false, "1.1.10", "0.0.2", PRIO_LOW, "c2" },
+  { 1, false, "0.0.2", "1.1.10", PRIO_LOW, "47d5000b1001" },
+  { 1, false, "0.0.2", "1.1.10", PRIO_LOW, "4a040101" },
+  { 1, false, "0.0.2", "1.1.10", PRIO_SYSTEM, "81" },
+  // long frame: memory write during programming
+  { 1, false, "0.0.2", "1.1.10", PRIO_LOW,
+    "4e9e0010000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d" },
+};
+
+static eibaddr_t
+read_ia (const char *s)
+{
+  int a, b, c;
+  sscanf (s, "%d.%d.%d", &a, &b, &c);
+  return (a << 12) | (b << 8) | c;
+}
+
+static eibaddr_t
+read_ga (const char *s)
+{
+  int a, b, c;
+  sscanf (s, "%d/%d/%d", &a, &b, &c);
+  return (a << 11) | (b << 8) | c;
+}
+
+static CArray
+read_hex (const std::string& s)
+{
+  CArray res;
+  int hi = -1;
+  for (char ch : s)
+    {
+      if (ch == '#')
+        break;
+      int v;
+      if (ch >= '0' && ch <= '9')
+        v = ch - '0';
+      else if (ch >= 'a' && ch <= 'f')
+        v = ch - 'a' + 10;
+      else if (ch >= 'A' && ch <= 'F')
+        v = ch - 'A' + 10;
+      else
+        continue;
+      if (hi < 0)
+        hi = v;
+      else
+        {
+          res.push_back ((hi << 4) | v);
+          hi = -1;
+        }
+    }
+  return res;
+}
+
+/* the benchmarks */
+
+static unsigned long sink = 0;
+
+template<typename _F>
+static void
+bench (const char *name, size_t n, int rounds, _F f)
+{
+  // warm up caches and pools
+  for (size_t i = 0; i < n; i++)
+    f (i);
+
+  unsigned long a0 = n_allocs;
+  auto t0 = std::chrono::steady_clock::now ();
+  for (int r = 0; r < rounds; r++)
+    for (size_t i = 0; i < n; i++)
+      f (i);
+  auto t1 = std::chrono::steady_clock::now ();
+  unsigned long a1 = n_allocs;
+
+  double frames = double (n) * rounds;
+  double ns = std::chrono::duration<double, std::nano> (t1 - t0).count ();
+  printf ("%-28s %9.1f ns/frame %6.2f allocs/frame\n", name, ns / frames, (a1 - a0) / frames);
+}
+
+int
+main (int argc, const char *argv[])
+{
+  int rounds = 2000;
+  const char *corpus = nullptr;
+
+  for (int i = 1; i < argc; i++)
+    if (!strcmp (argv[i], "-n") && i + 1 < argc)
+      rounds = atoi (argv[++i]);
+    else if (argv[i][0] != '-' && !corpus)
+      corpus = argv[i];
+    else
+      {
+        std::cerr << "Usage: " << argv[0] << " [-n ROUNDS] [corpus]" << std::endl;
+        exit(1);
+      }
+
+  IniData ini;
+  IniSectionPtr s = ini["bench"];
+  TracePtr t = TracePtr(new Trace(s, "bench"));
+
+  std::vector<CArray> tp1;
+  if (corpus)
+    {
+      std::ifstream in (corpus);
+      if (!in)
+        {
+          perror (corpus);
+          exit(1);
+        }
+      std::string line;
+      while (std::getline (in, line))
+        {
+          CArray c = read_hex (line);
+          if (c.size())
+            tp1.push_back (c);
+        }
+    }
+  else
+    for (auto& x : builtin)
+      {
+        LDataPtr l = L_Data_New ();
+        l->source_address = read_ia (x.src);
+        l->address_type = x.group ? GroupAddress : IndividualAddress;
+        l->destination_address = x.group ? read_ga (x.dst) : read_ia (x.dst);
+        l->priority = x.prio;
+        l->lsdu = read_hex (x.lsdu);
+        CArray c = L_Data_to_CM_TP1 (l);
+        for (int i = 0; i < x.weight; i++)
+          tp1.push_back (c);
+      }
+
+  // Everything else is derived from the valid TP1 frames.
+  std::vector<LDataPtr> ldata;
+  std::vector<CArray> good, cemi, emi, tsdu, ip;
+  size_t bad = 0;
+  for (auto& c : tp1)
+    {
+      LDataPtr l = CM_TP1_to_L_Data (c, t);
+      if (!l || !l->valid_checksum)
+        {
+          bad++;
+          continue;
+        }
+      cemi.push_back (L_Data_ToCEMI (0x29, l));
+      emi.push_back (L_Data_ToEMI (0x29, l));
+      EIBNetIPPacket p;
+      p.service = ROUTING_INDICATION;
+      p.data = cemi.back ();
+      ip.push_back (p.ToPacket ());
+      TPDUPtr tp = TPDU::fromPacket (l->address_type, l->destination_address, l->lsdu, t);
+      if (tp && tp->getType () == T_Data_Group)
+        tsdu.push_back (static_cast<T_Data_Group_PDU *>(tp.get ())->tsdu);
+      else if (tp && tp->getType () == T_Data_Connected)
+        tsdu.push_back (static_cast<T_Data_Connected_PDU *>(tp.get ())->tsdu);
+      ldata.push_back (l);
+      good.push_back (c);
+    }
+  if (bad)
+    printf ("skipped %zu invalid frames\n", bad);
+  if (ldata.empty ())
+    {
+      std::cerr << "No usable frames." << std::endl;
+      exit(1);
+    }
+  printf ("%zu frames, %d rounds\n", ldata.size (), rounds);
+
+  size_t n = ldata.size ();
+  bench ("CM_TP1_to_L_Data", n, rounds, [&](size_t i)
+  {
+    sink += CM_TP1_to_L_Data (good[i], t)->lsdu.size ();
+  });
+  bench ("L_Data_to_CM_TP1", n, rounds, [&](size_t i)
+  {
+    sink += L_Data_to_CM_TP1 (ldata[i]).size ();
+  });
+  bench ("CEMI_to_L_Data", n, rounds, [&](size_t i)
+  {
+    sink += CEMI_to_L_Data (cemi[i], t)->lsdu.size ();
+  });
+  bench ("L_Data_ToCEMI", n, rounds, [&](size_t i)
+  {
+    sink += L_Data_ToCEMI (0x29, ldata[i]).size ();
+  });
+  bench ("EMI_to_L_Data", n, rounds, [&](size_t i)
+  {
+    sink += EMI_to_L_Data (emi[i], t)->lsdu.size ();
+  });
+  bench ("L_Data_ToEMI", n, rounds, [&](size_t i)
+  {
+    sink += L_Data_ToEMI (0x29, ldata[i]).size ();
+  });
+  bench ("TPDU::fromPacket", n, rounds, [&](size_t i)
+  {
+    const LDataPtr& l = ldata[i];
+    sink += TPDU::fromPacket (l->address_type, l->destination_address, l->lsdu, t)->getType ();
+  });
+  if (tsdu.size ())
+    bench ("APDU::fromPacket", tsdu.size (), rounds, [&](size_t i)
+  {
+    sink += APDU::fromPacket (tsdu[i], t)->getType ();
+  });
+  struct sockaddr_in src;
+  memset (&src, 0, sizeof (src));
+  bench ("EIBNetIPPacket::fromPacket", n, rounds, [&](size_t i)
+  {
+    EIBNetIPPacket *p = EIBNetIPPacket::fromPacket (ip[i], src);
+    sink += p->data.size ();
+    delete p;
+  });
+  bench ("EIBNetIPPacket::ToPacket", n, rounds, [&](size_t i)
+  {
+    EIBNetIPPacket p;
+    p.service = ROUTING_INDICATION;
+    p.data = cemi[i];
+    sink += p.ToPacket ().size ();
+  });
+
+  return sink == 0;
+}
@@ -5,7 +5,7 @@
 export LD_LIBRARY_PATH=src/client/c/.libs${LD_LIBRARY_PATH:+:}$LD_LIBRARY_PATH
 
 set -ex
-export PATH="$(pwd)/src/tools/.libs:$(pwd)/src/tools:$(pwd)/src/server/.libs:$(pwd)/src/server:$(pwd)/src/server:$PATH"
+export PATH="$(pwd)/tools:$(pwd)/src/tools/.libs:$(pwd)/src/tools:$(pwd)/src/server/.libs:$(pwd)/src/server:$(pwd)/src/server:$PATH"
 
 EF=$(tempfile)
 
@@ -46,6 +46,268 @@ if knxd -e 1.2.3 --stop-right-now -T -b dummy: -b dummy: >$EF 2>&1; then
 	exit 1
 fi
 
+# more than 1024 clients at once, via Unix and TCP sockets, on epoll
+HN=$(ulimit -Hn)
+if [ "$HN" != "unlimited" ] && [ "$HN" -lt 2400 ]; then
+	echo "Open file limit $HN is too low – many-clients test skipped"
+else
+	SC=$(tempfile); rm $SC
+	IC=$(tempfile)
+	PORTC=$((9997 + $$))
+	cat >$IC <<EOF
+[main]
+addr = 4.4.0
+client-addrs = 4.5.0:2300
+connections = unix,tcp,A
+ev-backend = epoll
+[unix]
+server = knxd_unix
+path = $SC
+[tcp]
+server = knxd_tcp
+port = $PORTC
+[A]
+driver = dummy
+EOF
+	knxd $IC >$EF 2>&1 &
+	KNXC=$!
+	sleep 1
+	if ! bench_clients local:$SC,ip:127.0.0.1:$PORTC 1100 1 >>$EF 2>&1; then
+		echo "Many clients failed" >&2
+		kill $KNXC
+		cat $EF 2>&1
+		exit 1
+	fi
+	kill $KNXC
+	wait $KNXC || true
+	rm -f $IC
+fi
+
+# unicast to a tunnel, whose address is assigned after it has connected,
+# must go to the tunnel only
+S6=$(tempfile); rm $S6
+I5=$(tempfile)
+E6=$(tempfile)
+M6=$(tempfile)
+PORT6=$((9996 + $$))
+knxd -n K6 -e 4.6.0 -E 4.6.1:2 -u$S6 -D -T --Server=224.99.98.95:$PORT6 -bdummy: >$E6 2>&1 &
+KNX6=$!
+trap 'echo T6; rm -f $EF $I5 $E6 $M6; kill $KNX6 $KNX5; wait' 0 1 2
+sleep 1
+cat >$I5 <<EOF
+[main]
+addr = 4.5.0
+connections = tun,sink
+debug = D
+[D]
+error-level = 9
+[tun]
+driver = ipt
+ip-address = localhost
+dest-port = $PORT6
+[sink]
+driver = sink
+report-interval = 0
+[gen]
+driver = loadgen
+individual = 4.6.1
+group-ratio = 0
+count = 5
+EOF
+knxd $I5 >$EF 2>&1 &
+KNX5=$!
+sleep 2
+knxtool vbusmonitor1 local:$S6 >$M6 2>/dev/null &
+PM6=$!
+sleep 1
+# start sending once the tunnel is up
+sed -i -e 's/^connections = tun,sink$/connections = tun,sink,gen/' $I5
+kill -HUP $KNX5
+sleep 1
+kill $KNX5
+wait $KNX5 || true
+kill $PM6 || true
+kill $KNX6
+wait $KNX6 || true
+trap '' 0 1 2
+if [ "$(grep -c 'to 4.6.1 ' $M6)" != 5 ] || ! grep -q 'sink: total .* 0 frames' $EF; then
+	echo "Unicast to a tunnel failed" >&2
+	cat $EF $M6 2>&1
+	exit 1
+fi
+rm -f $I5 $E6 $M6
+
+# runtime counters, via the client interface and the stats file
+S7=$(tempfile); rm $S7
+I7=$(tempfile)
+F7=$(tempfile); rm $F7
+O7=$(tempfile)
+cat >$I7 <<EOF
+[main]
+addr = 4.7.0
+client-addrs = 4.7.1:2
+connections = unix,bus
+stats-file = $F7
+stats-interval = 0.5
+[unix]
+server = knxd_unix
+path = $S7
+[bus]
+driver = dummy
+EOF
+knxd $I7 >$EF 2>&1 &
+KNX7=$!
+trap 'echo T7; rm -f $EF $I7 $F7 $O7; kill $KNX7; wait' 0 1 2
+sleep 1
+knxtool groupswrite local:$S7 1/2/3 4
+knxtool stats local:$S7 >$O7
+sleep 1
+kill $KNX7
+wait $KNX7 || true
+trap '' 0 1 2
+if ! grep -q '^router rx=1 ' $O7 || ! grep -q '^link bus state=up .* tx=1 ' $O7 \
+		|| ! grep -q '^router rx=1 ' $F7 || ! grep -q '^link bus state=up ' $F7; then
+	echo "Stats failed" >&2
+	cat $EF $O7 $F7 2>&1
+	exit 1
+fi
+rm -f $I7 $F7 $O7
+
+# synthetic load, counted by the sink
+I8=$(tempfile)
+cat >$I8 <<EOF
+[main]
+addr = 4.8.0
+connections = gen,sink
+debug = D
+[D]
+error-level = 6
+[gen]
+driver = loadgen
+count = 100
+rate = 1000
+[sink]
+driver = sink
+report-interval = 0
+EOF
+knxd $I8 >$EF 2>&1 &
+KNX8=$!
+trap 'echo T8; rm -f $EF $I8; kill $KNX8; wait' 0 1 2
+sleep 1
+kill $KNX8
+wait $KNX8 || true
+trap '' 0 1 2
+if ! grep -q 'loadgen: sent 100 frames in ' $EF || ! grep -q 'sink: total .* 100 frames ' $EF; then
+	echo "Loadgen to sink failed" >&2
+	cat $EF 2>&1
+	exit 1
+fi
+# play back a recording, once and then in a loop
+for R in "speed = 10" "speed = 0
+loop = true"; do
+	cat >$I8 <<EOF
+[main]
+addr = 4.9.0
+connections = rec,sink
+debug = D
+[D]
+error-level = 6
+[rec]
+driver = replay
+file = $(dirname "$0")/logs/replay
+$R
+[sink]
+driver = sink
+report-interval = 0
+EOF
+	knxd $I8 >$EF 2>&1 &
+	KNX8=$!
+	trap 'echo T9; rm -f $EF $I8; kill $KNX8; wait' 0 1 2
+	sleep 1
+	kill $KNX8
+	wait $KNX8 || true
+	trap '' 0 1 2
+	N=$(sed -n -e 's/.*replay: \([0-9]*\) frames in .*/\1/p' $EF)
+	case "$R" in
+	*loop*) test "${N:-0}" -gt 100 ;;
+	*) test "$N" = 4 && grep -q 'sink: total .* 4 frames ' $EF ;;
+	esac || {
+		echo "Replay failed" >&2
+		cat $EF 2>&1
+		exit 1
+	}
+done
+# reloading the configuration
+S9=$(tempfile); rm $S9
+O9=$(tempfile)
+cat >$I8 <<EOF
+[main]
+addr = 4.10.0
+client-addrs = 4.10.1:2
+connections = unix,a,t
+debug = D
+[D]
+error-level = 6
+[unix]
+server = knxd_unix
+path = $S9
+[a]
+driver = dummy
+[t]
+driver = dummy
+thread = w1
+[b]
+driver = dummy
+EOF
+knxd $I8 >$EF 2>&1 &
+KNX8=$!
+trap 'echo T10; rm -f $EF $I8 $O9; kill $KNX8; wait' 0 1 2
+sleep 1
+reload() {
+	kill -HUP $KNX8
+	sleep 1
+}
+# add a link
+sed -i -e 's/^connections = .*/connections = unix,a,t,b/' $I8
+reload
+# change it
+sed -i -e 's/^\[b\]$/[b]\nignore = true/' $I8
+reload
+# remove it, and the threaded link which stays
+sed -i -e 's/^connections = .*/connections = unix,a/' $I8
+reload
+# typos don't kill the server
+echo '[broken' >>$I8
+reload
+sed -i -e '$d' -e '0,/^driver = dummy$/s//drvier = dummy/' $I8
+reload
+knxtool stats local:$S9 >$O9
+kill $KNX8
+wait $KNX8 || true
+trap '' 0 1 2
+for R in "Reloaded: 1 links started, 0 stopped, 3 unchanged" \
+		"Reloaded: 1 links started, 1 stopped, 3 unchanged" \
+		"t: threaded links can't be reloaded" \
+		"Reloaded: 0 links started, 1 stopped, 3 unchanged" \
+		"Parse error of '$I8' in line 19, not reloaded" \
+		"Section 'a': unrecognized argument 'drvier = dummy'" \
+		"Reloaded: 0 links started, 1 stopped, 1 unchanged" ; do
+	if ! grep -qF "$R" $EF; then
+		echo "Reload failed: $R" >&2
+		cat $EF 2>&1
+		exit 1
+	fi
+done
+if ! grep -q '^link unix state=up ' $O9 || ! grep -q '^link t state=up ' $O9 \
+		|| grep -q '^link [ab] ' $O9; then
+	echo "Reload failed" >&2
+	cat $EF $O9 2>&1
+	exit 1
+fi
+rm -f $O9
+
+rm -f $I8
+
 if ! knxd -e 1.2.3 --stop-right-now -c -b dummy: -b dummy: >$EF 2>&1; then
   echo "Group cache disabled – tests skipped – proceed on your own!"
   rm -f $EF
@@ -120,6 +382,9 @@ kill $PL4 || true
 if ! knxtool groupcacheread local:$S1 1/2/3 >>$L4 2>>$E4 ; then echo X7; exit 1;
 fi
 if ! knxtool groupcachelastupdates local:$S1 3 1 >>$L4 2>>$E4 ; then echo X7; exit 1; fi
+# ages depend on timing
+AGE='s/, [0-9]*s ago/, Ns ago/'
+knxtool groupcachereadbulk local:$S1 0 2>>$E4 | sed -e "$AGE" >>$L4
 
 #read RETURN
 kill $KNX1 $KNX2 $KNX3
@@ -127,6 +392,166 @@ sleep 1
 kill $PL1 $PL2 $PL3 $PL5 || true
 trap 'echo T3; rm -f $L1 $L2 $L3 $L4 $L5 $E1 $E2 $E3 $E4 $E5 $EF' 0 1 2
 sleep 1
+
+# the group cache on its own, with room for three entries
+S4=$(tempfile); rm $S4
+M4=$(tempfile)
+C4=$(tempfile)
+cat >$C4 <<END
+[main]
+addr = 4.4.0
+client-addrs = 4.4.1:10
+connections = unix,bus
+cache = gc
+[gc]
+max-size = 3
+read-timeout = 2
+read-interval = 60
+[unix]
+server = knxd_unix
+path = $S4
+[bus]
+driver = dummy
+END
+knxd $C4 &
+KNX4=$!
+trap 'echo T4; rm -f $L1 $L2 $L3 $L4 $L5 $E1 $E2 $E3 $E4 $E5 $EF $M4 $C4; kill $KNX4; wait' 0 1 2
+sleep 1
+knxtool vbusmonitor1 local:$S4 >$M4 2>>$E4 &
+PM4=$!
+sleep 1
+
+# two readers of an uncached address share one read request,
+# and both get the (same) answer
+knxtool groupcachereadsync local:$S4 2/0/1 >>$L4 2>&1 &
+PR1=$!
+knxtool groupcachereadsync local:$S4 2/0/1 >>$L4 2>&1 &
+PR2=$!
+sleep 1
+knxtool groupswrite local:$S4 2/0/1 9
+wait $PR1
+wait $PR2
+
+# nobody answers; the second reader doesn't cause another read request
+knxtool groupcachereadsync local:$S4 2/0/5 >>$L4 2>&1 || true
+knxtool groupcachereadsync local:$S4 2/0/5 >>$L4 2>&1 || true
+# longer than what fits into a cache slot
+knxtool groupwrite local:$S4 2/0/2 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f 10 11 12 13 14
+knxtool groupswrite local:$S4 2/0/3 3
+knxtool groupcacheread local:$S4 2/0/2 >>$L4 2>>$E4
+knxtool groupcachereadbulk local:$S4 0 2>>$E4 | sed -e "$AGE" >>$L4
+# paged: at most 40 bytes per reply
+knxtool groupcachereadbulk local:$S4 0:40 2>>$E4 | sed -e "$AGE" >>$L4
+knxtool groupcachereadbulk local:$S4 0 2/0/2-2/0/3 2>>$E4 | sed -e "$AGE" >>$L4
+
+# the cache is full: this drops 2/0/1
+knxtool groupswrite local:$S4 2/0/4 4
+knxtool groupcachelastupdates local:$S4 0 1 >>$L4 2>>$E4
+knxtool groupcachereadbulk local:$S4 0 2>>$E4 | sed -e "$AGE" >>$L4
+
+knxtool groupcachedisable local:$S4
+knxtool groupcachereadbulk local:$S4 0 >>$L4 2>&1 || true
+
+kill $KNX4
+sleep 1
+kill $PM4 || true
+echo "read requests: $(grep -c A_GroupValue_Read $M4)" >>$L4
+
+# the cache's contents survive a restart, without reading the bus;
+# a broken snapshot is ignored
+S10=$(tempfile); rm $S10
+P10=$(tempfile); rm $P10
+B10=$(tempfile)
+R10=$(tempfile)
+sed -e "s:^max-size = 3\$:snapshot = $P10\nsnapshot-interval = 0:" -e "s:^path = .*:path = $S10:" \
+	-e 's/^cache = gc$/cache = gc\ndebug = D/' <$C4 >$B10
+printf '[D]\nerror-level = 6\n' >>$B10
+mv $B10 $C4
+trap 'echo T11; rm -f $L1 $L2 $L3 $L4 $L5 $E1 $E2 $E3 $E4 $E5 $EF $M4 $C4 $P10 $B10 $R10; kill $KNX4; wait' 0 1 2
+snap() {
+	knxd $C4 >>$EF 2>&1 &
+	KNX4=$!
+	sleep 1
+	knxtool vbusmonitor1 local:$S10 >$M4 2>/dev/null &
+	PM4=$!
+	sleep 1
+}
+unsnap() {
+	kill $KNX4
+	wait $KNX4 || true
+	kill $PM4 || true
+}
+: >$EF
+snap
+knxtool groupswrite local:$S10 2/0/1 9
+knxtool groupwrite local:$S10 2/0/2 01 02 03
+sleep 1
+unsnap
+cp $P10 $B10
+snap
+knxtool groupcachereadsync local:$S10 2/0/1 0 >>$R10
+knxtool groupcachereadsync local:$S10 2/0/2 0 >>$R10
+unsnap
+echo "read requests: $(grep -c A_GroupValue_Read $M4)" >>$R10
+# the second entry is cut off
+head -c 56 $B10 >$P10
+snap
+knxtool groupcachereadsync local:$S10 2/0/1 0 >>$R10
+unsnap
+echo "read requests: $(grep -c A_GroupValue_Read $M4)" >>$R10
+echo "knxdGC garbage garbage garbage" >$P10
+snap
+knxtool groupcachereadbulk local:$S10 0 >>$R10
+unsnap
+printf 'Write: 09\nWrite: 01 02 03 \nread requests: 0\nWrite: 09\nread requests: 0\n' >$B10
+sed -i -e 's/ from [0-9.]*:/:/' $R10
+if ! diff -u $B10 $R10 || ! grep -q "snapshot $P10: 2 entries loaded" $EF \
+		|| ! grep -q "snapshot $P10: truncated" $EF || ! grep -q "snapshot $P10: 1 entries loaded" $EF \
+		|| ! grep -q "snapshot $P10: unknown format" $EF; then
+	echo "Cache snapshot failed" >&2
+	cat $EF 2>&1
+	exit 1
+fi
+rm -f $P10 $B10 $R10
+
+# warm-up: one read per second, which a client's read joins
+cat >$C4 <<EOF
+[main]
+addr = 4.12.0
+client-addrs = 4.12.1:2
+connections = unix,bus
+cache = gc
+[gc]
+warmup = 3/0/1:3 3/0/10
+warmup-delay = 1
+debug = D
+[D]
+trace-mask = 0x110
+[unix]
+server = knxd_unix
+path = $S10
+[bus]
+driver = dummy
+EOF
+knxd $C4 >$EF 2>&1 &
+KNX4=$!
+sleep 1
+knxtool vbusmonitor1time local:$S10 >$M4 2>/dev/null &
+PM4=$!
+sleep 2
+knxtool groupcachereadsync local:$S10 3/0/1 >/dev/null 2>&1 || true
+sleep 4
+unsnap
+if [ "$(sed -n -e 's/.* to \([0-9/]*\) .*A_GroupValue_Read.*/\1/p' $M4 | tr '\n' ' ')" != "3/0/1 3/0/2 3/0/3 3/0/10 " ] \
+		|| ! awk '/A_GroupValue_Read/ { split($1, a, ":"); t = a[1]*3600 + a[2]*60 + a[3];
+			if (n++ && t - p < 0.9) bad = 1; p = t } END { exit bad }' $M4 \
+		|| ! grep -q 'bus reads: 4 sent, 1 joined a pending one' $EF; then
+	echo "Cache warm-up failed" >&2
+	cat $EF $M4 2>&1
+	exit 1
+fi
+rm -f $M4 $C4
+trap 'echo T3; rm -f $L1 $L2 $L3 $L4 $L5 $E1 $E2 $E3 $E4 $E5 $EF' 0 1 2
 #ls -l $L1 $L2 $E1 $E2
 #cat $L1 $L2 $E1 $E2
 sed -e 's/^/E vbusmonitor 1: /' <$E1
@@ -0,0 +1,240 @@
+/*
+    EIBD eib bus access and management daemon
+    Copyright (C) 2005-2011 Martin Koegler <mkoegler@auto.tuwien.ac.at>
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+*/
+
+#include "types.h"
+
+#include <iostream>
+#include <utility>
+
+static int errors = 0;
+
+#define CHECK(_c) do { if (!(_c)) { \
+      std::cerr << __FILE__ << ":" << __LINE__ << ": failed: " #_c << std::endl; \
+      errors++; } } while (0)
+
+/** is the content stored in the object itself? */
+static bool
+is_inline (const CArray& a)
+{
+  const uint8_t *p = a.data();
+  return p >= (const uint8_t *)&a && p < (const uint8_t *)(&a + 1);
+}
+
+/** 0, 1, 2, … */
+static CArray
+seq (size_t n, uint8_t start = 0)
+{
+  CArray a;
+  for (size_t i = 0; i < n; i++)
+    a.push_back (start + i);
+  return a;
+}
+
+static bool
+is_seq (const CArray& a, size_t n, uint8_t start = 0)
+{
+  if (a.size() != n)
+    return false;
+  for (size_t i = 0; i < n; i++)
+    if (a[i] != (uint8_t)(start + i))
+      return false;
+  return true;
+}
+
+static void
+test_boundary ()
+{
+  const size_t n = CArray::inline_size;
+  CHECK (n == 40);
+
+  CArray a = seq (n);
+  CHECK (is_inline (a));
+  CHECK (a.capacity() == n);
+  a.push_back (n);
+  CHECK (!is_inline (a));
+  CHECK (is_seq (a, n + 1));
+
+  CArray b (n);
+  CHECK (is_inline (b) && b.size() == n && b[n-1] == 0);
+  b.resize (n + 1, 7);
+  CHECK (!is_inline (b) && b.size() == n + 1 && b[n-1] == 0 && b[n] == 7);
+
+  // shrinking doesn't move the content back
+  b.resize (2);
+  CHECK (!is_inline (b) && b.size() == 2);
+
+  CArray c;
+  c.reserve (n + 1);
+  CHECK (!is_inline (c) && c.empty());
+
+  // inserting across the boundary
+  CArray d = seq (n - 2);
+  d.insert (d.begin() + 1, 4, 0xff);
+  CHECK (!is_inline (d) && d.size() == n + 2);
+  CHECK (d[0] == 0 && d[1] == 0xff && d[4] == 0xff && d[5] == 1 && d[n+1] == n - 3);
+
+  CArray e = seq (n);
+  e += seq (n, n);
+  CHECK (is_seq (e, 2 * n));
+
+  // inserting a part of itself, which moves to the heap meanwhile
+  CArray f = seq (n);
+  f.insert (f.end(), f.begin(), f.begin() + 10);
+  CHECK (f.size() == n + 10 && f[n] == 0 && f[n+9] == 9 && f[n-1] == n - 1);
+
+  f.erase (f.begin(), f.begin() + 10);
+  CHECK (f.size() == n && f[0] == 10);
+  f.deletepart (n - 5, 100);
+  CHECK (f.size() == n - 5);
+  f.deletepart (n, 1);
+  CHECK (f.size() == n - 5);
+}
+
+static void
+test_copy_move ()
+{
+  const size_t n = CArray::inline_size;
+  CArray small = seq (n);
+  CArray big = seq (n + 10);
+
+  CArray a (small);
+  CHECK (is_inline (a) && a == small);
+  CArray b (big);
+  CHECK (!is_inline (b) && b == big && b.data() != big.data());
+
+  // assignments between inline and heap content, both ways
+  CArray c = seq (3);
+  c = big;
+  CHECK (c == big);
+  c = small;
+  CHECK (c == small);
+  CArray d = seq (n + 20);
+  d = small;
+  CHECK (d == small);
+  d = d;
+  CHECK (d == small);
+
+  // moving heap storage hands over the pointer
+  CArray e (big);
+  const uint8_t *p = e.data();
+  CArray f (std::move (e));
+  CHECK (f.data() == p && f == big);
+  CHECK (e.empty() && is_inline (e));
+  e.push_back (1);
+  CHECK (e.size() == 1 && e[0] == 1);
+
+  // moving inline storage copies it
+  CArray g (small);
+  CArray h (std::move (g));
+  CHECK (is_inline (h) && h == small && g.empty());
+
+  CArray i = seq (5);
+  i = std::move (f);
+  CHECK (i.data() == p && i == big && f.empty());
+  CArray j = seq (n + 5);
+  j = std::move (h);
+  CHECK (is_inline (j) && j == small);
+
+  CArray k (big), l (small);
+  k.swap (l);
+  CHECK (k == small && l == big && is_inline (k));
+
+  CHECK (small < big && !(big < small) && small != big);
+}
+
+static void
+test_setpart ()
+{
+  const size_t n = CArray::inline_size;
+  const uint8_t x[] = { 9, 8, 7, 6 };
+
+  CArray a = seq (3);
+  a.setpart (x, 5, 4);
+  CHECK (a.size() == 9);
+  CHECK (a[2] == 2 && a[3] == 0 && a[4] == 0 && a[5] == 9 && a[8] == 6);
+
+  // doesn't shrink
+  a.setpart (x, 0, 2);
+  CHECK (a.size() == 9 && a[0] == 9 && a[1] == 8 && a[2] == 2);
+
+  // grows across the boundary, keeping the content
+  CArray b = seq (n - 2);
+  b.setpart (x, n - 1, 4);
+  CHECK (!is_inline (b) && b.size() == n + 3);
+  CHECK (b[n-3] == n - 3 && b[n-2] == 0 && b[n-1] == 9 && b[n+2] == 6);
+
+  CArray c;
+  c.setpart (seq (n + 1), 1);
+  CHECK (c.size() == n + 2 && c[0] == 0 && c[1] == 0 && c[n+1] == n);
+
+  // strings include their terminating null character
+  CArray d;
+  d.setpart (std::string ("ab"), 2);
+  CHECK (d.size() == 5 && d[2] == 'a' && d[3] == 'b' && d[4] == 0);
+
+  CArray e = seq (n);
+  e.set (x, 4);
+  CHECK (e.size() == 4 && e[0] == 9 && e[3] == 6);
+  e.set (seq (n + 1));
+  CHECK (is_seq (e, n + 1));
+}
+
+static void
+test_slices ()
+{
+  const size_t n = CArray::inline_size;
+  CArray big = seq (n + 10);
+
+  CArray a (big.data(), 5, n);
+  CHECK (is_seq (a, n, 5));
+  CArray b (big.data(), n + 10);
+  CHECK (b == big);
+  CArray c (big.data(), 0);
+  CHECK (c.empty());
+
+  CArray d (big.begin() + 2, big.end());
+  CHECK (is_seq (d, n + 8, 2));
+  CArray e { 1, 2, 3 };
+  CHECK (is_seq (e, 3, 1));
+
+  // These have always computed their length as pos-size, so any
+  // position within the array gives an empty one. Kept as it was.
+  CArray f (big, 3);
+  CHECK (f.empty());
+  CArray g (big, n + 10);
+  CHECK (g.empty());
+  CArray h (big, 3, 10);
+  CHECK (h.empty());
+}
+
+int
+main ()
+{
+  test_boundary ();
+  test_copy_move ();
+  test_setpart ();
+  test_slices ();
+  if (errors)
+    {
+      std::cerr << errors << " CArray tests failed." << std::endl;
+      return 1;
+    }
+  std::cerr << "All CArray tests completed correctly." << std::endl;
+  return 0;
+}